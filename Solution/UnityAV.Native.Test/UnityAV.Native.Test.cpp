@@ -1,8 +1,10 @@
 // UnityAV.Native.Test.cpp : Defines the entry point for the console application.
 //
 #include "stdafx.h"
+#ifdef _MSC_VER
 #define _CRTDBG_MAP_ALLOC
 #include <crtdbg.h>
+#endif
 
 #include <SDL.h>
 #include "SDLWindow.h"
@@ -10,6 +12,7 @@
 #include "Rendering/SDLWindowWriter.h"
 #include "TextureClient.h"
 #include "Rendering/NullTextureWriter.h"
+#include "Live555TestServer.h"
 
 mutex gMutex;
 
@@ -180,6 +183,160 @@ void RTSPTest(bool multiple)
     RunTest(uris);
 }
 
+/**
+ * \brief Counts the frames a player hands on and the gaps between them
+ */
+class BenchmarkClient : public IVideoClient
+{
+public:
+    explicit BenchmarkClient(unique_ptr<IVideoClient> client) : _client(move(client)),
+        _firstFrameTime(-1), _lastFrameTime(-1), _maxFrameGap(0)
+    {
+        _frames.store(0);
+    }
+
+    PixelFormat Format() const override { return _client->Format(); }
+    int Width() const override { return _client->Width(); }
+    int Height() const override { return _client->Height(); }
+    void Write() override { _client->Write(); }
+
+    void OnFrameReady(VideoFrame& frame) override
+    {
+        auto now = av_gettime_relative();
+
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            if (_firstFrameTime < 0)
+            {
+                _firstFrameTime = now;
+            }
+            else
+            {
+                _maxFrameGap = max(_maxFrameGap, now - _lastFrameTime);
+            }
+
+            _lastFrameTime = now;
+        }
+
+        _frames++;
+        _client->OnFrameReady(frame);
+    }
+
+    int64_t Frames() const { return _frames.load(); }
+    int64_t FirstFrameTime() const { lock_guard<mutex> lock(_mutex); return _firstFrameTime; }
+    int64_t MaxFrameGap() const { lock_guard<mutex> lock(_mutex); return _maxFrameGap; }
+    void ResetMaxFrameGap() { lock_guard<mutex> lock(_mutex); _maxFrameGap = 0; }
+
+private:
+    unique_ptr<IVideoClient> _client;
+    atomic<int64_t> _frames;
+    int64_t _firstFrameTime, _lastFrameTime, _maxFrameGap;
+    mutable mutex _mutex;
+};
+
+void RunStreamingBenchmark(const string& label, const string& uri, 
+    const PlayerOptions& options, int seconds, Live555TestServer& server)
+{
+    auto writer = unique_ptr<TextureWriter>(make_unique<NullTextureWriter>(1280, 800));
+    auto benchmarkClient = make_unique<BenchmarkClient>(
+        make_unique<TextureClient>(move(writer)));
+    auto& client = *benchmarkClient;
+
+    auto start = av_gettime_relative();
+    auto player = Player::Create(uri, move(benchmarkClient), options);
+    if (player == nullptr)
+    {
+        Debug::Log("RunStreamingBenchmark - %s failed to create a player", label.c_str());
+        return;
+    }
+
+    player->Play();
+
+    auto runFor = [&player](int64_t duration)
+    {
+        auto end = av_gettime_relative() + duration;
+        while (av_gettime_relative() < end)
+        {
+            player->Write();
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+    };
+
+    // the first half measures steady playback
+    runFor(static_cast<int64_t>(seconds) * 500000);
+
+    auto now = av_gettime_relative();
+    auto statistics = player->Statistics();
+    auto firstFrameTime = client.FirstFrameTime();
+    auto frames = client.Frames();
+    auto maxFrameGap = client.MaxFrameGap();
+    auto playing = firstFrameTime < 0 ? 0.0 : (now - firstFrameTime) / 1000000.0;
+
+    // the second half measures the outage of the server dropping every session
+    client.ResetMaxFrameGap();
+    server.DropClients();
+    runFor(static_cast<int64_t>(seconds) * 500000);
+
+    Debug::Log("RunStreamingBenchmark - %s: first frame %.1fms, %.2ffps, longest gap %.1fms, "
+        "buffer delay %.1fms, %lld late frames, %lld packets lost, longest gap across the "
+        "outage %.1fms", 
+        label.c_str(), firstFrameTime < 0 ? -1.0 : (firstFrameTime - start) / 1000.0,
+        playing > 0 ? frames / playing : 0.0, maxFrameGap / 1000.0,
+        statistics.JitterBufferDelayMilliseconds, statistics.LateFrames, 
+        statistics.PacketsLost, client.MaxFrameGap() / 1000.0);
+}
+
+void StreamingBenchmark(int seconds)
+{
+    // annex b and mjpeg copies of the sample, made alongside it with ffmpeg:
+    // ffmpeg -i SampleVideo_1280x720_10mb.mp4 -an -c:v copy -bsf:v h264_mp4toannexb
+    //     SampleVideo_1280x720.h264
+    // ffmpeg -i SampleVideo_1280x720_10mb.mp4 -an -c:v mjpeg -pix_fmt yuvj420p -q:v 3
+    //     -f mjpeg SampleVideo_1280x720.mjpeg
+    auto h264 = Live555TestStream();
+    h264.Name = "h264";
+    h264.Path = "../TestFiles/SampleVideo_1280x720.h264";
+
+    auto lossy = h264;
+    lossy.Name = "h264-lossy";
+    lossy.PacketLoss = 0.01;
+    lossy.JitterMilliseconds = 30;
+
+    auto constrained = h264;
+    constrained.Name = "h264-2mbps";
+    constrained.MaxKilobitsPerSecond = 2000;
+
+    auto mjpeg = Live555TestStream();
+    mjpeg.Name = "mjpeg";
+    mjpeg.Path = "../TestFiles/SampleVideo_1280x720.mjpeg";
+    mjpeg.Codec = LIVE555_TEST_CODEC_MJPEG;
+
+    auto streams = vector<Live555TestStream>{ h264, lossy, constrained, mjpeg };
+    auto server = Live555TestServer::Create(streams);
+    if (server == nullptr)
+    {
+        return;
+    }
+
+    const char* backendNames[] = { "live555", "avformat" };
+    RTSPBackend backends[] = { RTSP_BACKEND_LIVE555, RTSP_BACKEND_AVFORMAT };
+
+    for (auto i = 0; i < streams.size(); ++i)
+    {
+        for (auto j = 0; j < 2; ++j)
+        {
+            // the network is only emulated for udp
+            auto options = PlayerOptions();
+            options.Backend = backends[j];
+            options.Transport = RTSP_TRANSPORT_UDP;
+
+            RunStreamingBenchmark(streams[i].Name + " over " + backendNames[j], 
+                server->Uri(streams[i].Name), options, seconds, *server);
+        }
+    }
+}
+
 void FileTest(bool loopPlayers = false)
 {
     vector<string> uris;
@@ -200,17 +357,30 @@ void FileTestInvalidUri()
 
 int main(int argc, char** argv)
 {
+#ifdef _MSC_VER
     _CrtMemState memState;
     _CrtMemCheckpoint(&memState);
+#endif
 
     Debug::Initialize(false);
 
-    FileTest(true);
-    //RTSPTest(true);
+    // the benchmark renders to null writers, so it runs headless without sdl:
+    // UnityAV.Native.Test --benchmark [seconds]
+    if (argc > 1 && string(argv[1]) == "--benchmark")
+    {
+        StreamingBenchmark(argc > 2 ? max(atoi(argv[2]), 2) : 30);
+    }
+    else
+    {
+        FileTest(true);
+        //RTSPTest(true);
+    }
 
     Debug::Teardown();
 
+#ifdef _MSC_VER
     _CrtMemDumpAllObjectsSince(&memState);
+#endif
 
     return 0;
 }
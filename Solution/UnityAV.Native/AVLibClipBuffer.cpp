@@ -0,0 +1,206 @@
+﻿#include "stdafx.h"
+#include "AVLibClipBuffer.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        AVLibClipBuffer::~AVLibClipBuffer()
+        {
+            auto finishingClips = vector<unique_ptr<AVLibRecorder>>();
+
+            {
+                lock_guard<mutex> lock(_mutex);
+
+                for (auto i = 0; i < _clips.size(); ++i)
+                {
+                    _clips[i].Recorder->Finish();
+                    _finishingClips.push_back(move(_clips[i].Recorder));
+                }
+
+                _clips.clear();
+                finishingClips = move(_finishingClips);
+            }
+
+            // waits for every clip's file to be finished
+            finishingClips.clear();
+        }
+
+        AVLibClipBuffer::AVLibClipBuffer(const IAVLibSource& source, int64_t maxDuration,
+            int64_t maxMemory) : _newestTime(-1)
+        {
+            if (maxDuration > 0)
+            {
+                _ring = make_unique<AVLibPacketRing>(maxDuration, maxMemory, 0);
+            }
+
+            for (auto i = 0; i < source.StreamCount(); ++i)
+            {
+                // live sources express time in their own base rather than the stream's
+                auto& stream = source.Stream(i);
+                _timeBases.push_back(stream.time_base.num > 0 && stream.time_base.den > 0 ?
+                    stream.time_base : av_d2q(source.TimeBase(i), INT_MAX));
+                _videoStreams.push_back(source.StreamType(i) == AVMEDIA_TYPE_VIDEO);
+            }
+        }
+
+        void AVLibClipBuffer::OnPacket(int streamIndex, const AVPacket& packet, bool discontinuity)
+        {
+            if (streamIndex < 0 || streamIndex >= _timeBases.size())
+            {
+                return;
+            }
+
+            auto timestamp = packet.pts != AV_NOPTS_VALUE ? packet.pts : packet.dts;
+            if (timestamp == AV_NOPTS_VALUE)
+            {
+                return;
+            }
+
+            auto& timeBase = _timeBases[streamIndex];
+            auto time = av_rescale_q(timestamp, timeBase, AV_TIME_BASE_Q);
+
+            lock_guard<mutex> lock(_mutex);
+
+            _newestTime = max(_newestTime, time);
+
+            if (_ring != nullptr)
+            {
+                // the data is copied, the source's buffer may be far larger than the packet
+                auto copy = CreatePacket(packet.size);
+                if (copy != nullptr)
+                {
+                    memcpy(copy->data, packet.data, packet.size);
+
+                    copy->pts = time;
+                    copy->dts = packet.dts != AV_NOPTS_VALUE ?
+                        av_rescale_q(packet.dts, timeBase, AV_TIME_BASE_Q) : AV_NOPTS_VALUE;
+                    copy->duration = packet.duration;
+                    copy->stream_index = streamIndex;
+
+                    // clips begin on a video keyframe, every audio packet is flagged as one
+                    copy->flags = _videoStreams[streamIndex] ? packet.flags : 0;
+
+                    _ring->Push(move(copy), discontinuity);
+                }
+            }
+
+            for (auto i = 0; i < _clips.size();)
+            {
+                auto& clip = _clips[i];
+
+                // clips asked for before any packet arrived end after their first
+                if (clip.EndTime < 0)
+                {
+                    clip.EndTime = time + clip.Duration;
+                }
+
+                if (time <= clip.EndTime)
+                {
+                    clip.Recorder->OnPacket(streamIndex, packet, discontinuity);
+                    ++i;
+                    continue;
+                }
+
+                clip.Recorder->Finish();
+                _finishingClips.push_back(move(clip.Recorder));
+                _clips.erase(_clips.begin() + i);
+            }
+        }
+
+        bool AVLibClipBuffer::SaveClip(const string& path, double secondsBefore,
+            double secondsAfter, const IAVLibSource& source)
+        {
+            if (secondsBefore < 0 || secondsAfter < 0)
+            {
+                Debug::LogError("AVLibClipBuffer::SaveClip - seconds must not be negative");
+                return false;
+            }
+
+            if (secondsBefore > 0 && _ring == nullptr)
+            {
+                Debug::LogWarning("AVLibClipBuffer::SaveClip - no packets are kept before the "
+                    "clip is asked for, the clip begins now");
+            }
+
+            // the packets kept before the event are all queued to be written at once
+            auto bufferedPackets = _ring != nullptr ? _ring->Count() : 0;
+            auto maxQueuedPackets = min<int64_t>(bufferedPackets, INT_MAX / 2) +
+                AVLibRecorder::DefaultMaxQueuedPackets;
+
+            // the source isn't touched while locked, it may be giving this packets
+            auto recorder = AVLibRecorder::Create(path, source,
+                static_cast<int>(maxQueuedPackets));
+            if (recorder == nullptr)
+            {
+                Debug::LogError("AVLibClipBuffer::SaveClip - failed to create a recorder");
+                return false;
+            }
+
+            auto finishedClips = vector<unique_ptr<AVLibRecorder>>();
+            {
+                lock_guard<mutex> lock(_mutex);
+                QueueBufferedPackets(*recorder, secondsBefore);
+
+                auto after = static_cast<int64_t>(secondsAfter * kSecondToMicrosecond);
+                _clips.push_back({ move(recorder), after, 
+                    _newestTime >= 0 ? _newestTime + after : -1 });
+
+                finishedClips = TakeFinishedClips();
+            }
+
+            // finished clips are let go of unlocked, though their writers have exited
+            finishedClips.clear();
+
+            return true;
+        }
+
+        void AVLibClipBuffer::QueueBufferedPackets(AVLibRecorder& recorder, double secondsBefore)
+        {
+            if (_ring != nullptr && _newestTime >= 0)
+            {
+                auto before = static_cast<int64_t>(secondsBefore * kSecondToMicrosecond);
+                auto sequence = _ring->FindKeyframe(_newestTime - before);
+
+                auto packet = AVPacket();
+                av_init_packet(&packet);
+                packet.data = nullptr;
+                packet.size = 0;
+
+                auto discontinuity = false;
+                while (sequence >= 0 && _ring->TryGet(-1, sequence, packet, discontinuity))
+                {
+                    auto& timeBase = _timeBases[packet.stream_index];
+                    packet.pts = av_rescale_q(packet.pts, AV_TIME_BASE_Q, timeBase);
+                    if (packet.dts != AV_NOPTS_VALUE)
+                    {
+                        packet.dts = av_rescale_q(packet.dts, AV_TIME_BASE_Q, timeBase);
+                    }
+
+                    recorder.OnPacket(packet.stream_index, packet, discontinuity);
+                    av_packet_unref(&packet);
+                    ++sequence;
+                }
+            }
+        }
+
+        vector<unique_ptr<AVLibRecorder>> AVLibClipBuffer::TakeFinishedClips()
+        {
+            auto finishedClips = vector<unique_ptr<AVLibRecorder>>();
+
+            for (auto i = 0; i < _finishingClips.size();)
+            {
+                if (!_finishingClips[i]->IsFinished())
+                {
+                    ++i;
+                    continue;
+                }
+
+                finishedClips.push_back(move(_finishingClips[i]));
+                _finishingClips.erase(_finishingClips.begin() + i);
+            }
+
+            return finishedClips;
+        }
+    }
+}
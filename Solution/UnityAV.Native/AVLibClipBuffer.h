@@ -0,0 +1,84 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "AVLibPacketRing.h"
+#include "AVLibRecorder.h"
+#include "IAVLibSource.h"
+#include "IAVLibPacketListener.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for keeping the last seconds of a source's packets so clips
+         * can be saved which begin before they were asked for, the clips are written by
+         * recorders on threads of their own
+         */
+        class AVLibClipBuffer : public IAVLibPacketListener
+        {
+        public:
+            /**
+             * \brief Deconstructs an instance of AVLibClipBuffer, clips still recording
+             * are cut short and finished
+             */
+            virtual ~AVLibClipBuffer();
+            /**
+             * \brief Initializes a new instance of AVLibClipBuffer
+             * \param source The connected source the packets come from
+             * \param maxDuration The span of packets kept in microseconds, zero keeps none
+             * \param maxMemory The bytes of packets kept
+             */
+            explicit AVLibClipBuffer(const IAVLibSource& source, int64_t maxDuration,
+                int64_t maxMemory);
+            // Disabled copy constructor
+            explicit AVLibClipBuffer(const AVLibClipBuffer&& other) = delete;
+            // Disabled copy assignment
+            AVLibClipBuffer& operator=(const AVLibClipBuffer&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibClipBuffer(AVLibClipBuffer&& other) = delete;
+            // Disabled move assignment
+            AVLibClipBuffer& operator=(AVLibClipBuffer&& other) = delete;
+
+            void OnPacket(int streamIndex, const AVPacket& packet, bool discontinuity) override;
+
+            /**
+             * \brief Saves a clip around the newest packet received, without blocking
+             * \param path The path of the file, .mp4 or .mkv
+             * \param secondsBefore The seconds kept before the newest packet to begin the
+             * clip with, it begins at the keyframe at or before then
+             * \param secondsAfter The seconds after the newest packet to end the clip at
+             * \param source The source the packets come from
+             * \return True if the clip was started, false otherwise
+             */
+            bool SaveClip(const string& path, double secondsBefore, double secondsAfter,
+                const IAVLibSource& source);
+
+        private:
+            /**
+             * \brief A clip recording packets until its end time
+             */
+            struct Clip
+            {
+                unique_ptr<AVLibRecorder> Recorder;
+                int64_t Duration;
+                int64_t EndTime;
+            };
+
+            void QueueBufferedPackets(AVLibRecorder& recorder, double secondsBefore);
+            vector<unique_ptr<AVLibRecorder>> TakeFinishedClips();
+
+            // packets before the event, their times are kept in microseconds
+            unique_ptr<AVLibPacketRing> _ring;
+            vector<AVRational> _timeBases;
+            vector<bool> _videoStreams;
+            int64_t _newestTime;
+
+            // clips, recording until their end time and then finishing
+            vector<Clip> _clips;
+            vector<unique_ptr<AVLibRecorder>> _finishingClips;
+            mutex _mutex;
+        };
+    }
+}
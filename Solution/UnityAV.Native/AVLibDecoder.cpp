@@ -8,24 +8,34 @@ namespace UnityAV
     namespace Media
     {
         AVLibDecoder::AVLibDecoder(IAVLibSource& source, unique_ptr<AVCodecContext,
-            AVCodecContextDeleter> codecContext, int streamIndex) 
+            AVCodecContextDeleter> codecContext, int streamIndex, function<void()> onFrameReady) 
             : _source(source), _codecContext(move(codecContext)), 
-            _streamIndex(streamIndex), _successfulDecodes(0), _failedDecodes(0),
+            _streamIndex(streamIndex), _onFrameReady(move(onFrameReady)), _successfulDecodes(0), _failedDecodes(0),
             _successfulParses(0), _failedParses(0)
         {
             _timeBase = source.TimeBase(streamIndex);
             _frameRate = source.FrameRate(streamIndex);
             _frameDuration = source.FrameDuration(streamIndex);
+            _flushRequest.store(false);
+
+            // keep the parameters the decoder was opened with to compare against later
+            _parameters = unique_ptr<AVCodecParameters, AVCodecParametersDeleter>(
+                avcodec_parameters_alloc());
+            if (_parameters)
+            {
+                avcodec_parameters_copy(_parameters.get(), source.Stream(streamIndex).codecpar);
+            }
         }
 
         vector<unique_ptr<AVLibDecoder>> AVLibDecoder::Create(IAVLibSource& source,
-            const IVideoDescription& requiredVideo)
+            const vector<VideoDescription>& requiredVideo, const PlayerOptions& options,
+            function<void()> onFrameReady)
         {
             // for each stream found by the source, create a decoder
             auto decoders = vector<unique_ptr<AVLibDecoder>>();
             for(auto i = 0; i < source.StreamCount(); ++i)
             {
-                auto decoder = Create(source, i, requiredVideo);
+                auto decoder = Create(source, i, requiredVideo, options, onFrameReady);
 
                 if(decoder)
                 {
@@ -36,6 +46,54 @@ namespace UnityAV
             return decoders;
         }
 
+        bool AVLibDecoder::IsServingFromCache() const
+        {
+            return false;
+        }
+
+        void AVLibDecoder::CollectStatistics(PlayerStatistics& statistics) const
+        {
+
+        }
+
+        void AVLibDecoder::SetMaxFrameRate(double framesPerSecond)
+        {
+
+        }
+
+        bool AVLibDecoder::CanDecode(IAVLibSource& source) const
+        {
+            if (!_parameters || _streamIndex >= source.StreamCount())
+            {
+                return false;
+            }
+
+            auto parameters = source.Stream(_streamIndex).codecpar;
+
+            if (parameters == nullptr)
+            {
+                return false;
+            }
+
+            return parameters->codec_id == _parameters->codec_id &&
+                parameters->width == _parameters->width &&
+                parameters->height == _parameters->height &&
+                parameters->extradata_size == _parameters->extradata_size &&
+                (parameters->extradata_size == 0 || memcmp(parameters->extradata,
+                    _parameters->extradata, parameters->extradata_size) == 0);
+        }
+
+        void AVLibDecoder::Flush()
+        {
+            _flushRequest.store(true);
+            ContinueDecoding();
+        }
+
+        void AVLibDecoder::OnFlush()
+        {
+            avcodec_flush_buffers(_codecContext.get());
+        }
+
         void AVLibDecoder::StopDecoding()
         {
             // terminate the running thread
@@ -64,6 +122,14 @@ namespace UnityAV
             ContinueDecoding();
         }
 
+        void AVLibDecoder::OnFrameReady()
+        {
+            if (_onFrameReady)
+            {
+                _onFrameReady();
+            }
+        }
+
         AVCodecContext& AVLibDecoder::GetCodecContext()
         {
             return *_codecContext;
@@ -90,7 +156,8 @@ namespace UnityAV
         }
 
         unique_ptr<AVLibDecoder> AVLibDecoder::Create(IAVLibSource& source, int streamIndex,
-            const IVideoDescription& requiredVideo)
+            const vector<VideoDescription>& requiredVideo, const PlayerOptions& options,
+            function<void()> onFrameReady)
         {
             // we need a codec context
             auto codecContext = unique_ptr<AVCodecContext, AVCodecContextDeleter>(
@@ -127,6 +194,29 @@ namespace UnityAV
                 return nullptr;
             }
 
+            // live streams at low latency output each frame as soon as it's decoded,
+            // frame threading would hold back a frame per thread
+            if (options.LowLatency && source.IsRealtime())
+            {
+                codecContext->flags |= AV_CODEC_FLAG_LOW_DELAY;
+                codecContext->thread_type = FF_THREAD_SLICE;
+                codecContext->has_b_frames = 0;
+            }
+
+            // small targets of large frames are decoded at a fraction of the size, which
+            // for dct based codecs skips most of the decoding as well as the scaling
+            if (codecContext->codec_type == AVMEDIA_TYPE_VIDEO && !requiredVideo.empty())
+            {
+                codecContext->lowres = AVLibVideoDecoder::LowResolution(*codec, 
+                    *codecContext, requiredVideo);
+
+                if (codecContext->lowres > 0)
+                {
+                    Debug::Log("AVLibDecoder::Create: Decoding at 1/%d resolution", 
+                        1 << codecContext->lowres);
+                }
+            }
+
             // we must open the codec before starting any decoding
             AVDictionary * fakeCodecOptions = nullptr;
             result = avcodec_open2(codecContext.get(), codec, &fakeCodecOptions);
@@ -149,7 +239,7 @@ namespace UnityAV
             case AVMEDIA_TYPE_UNKNOWN:break;
             case AVMEDIA_TYPE_VIDEO:
                 return make_unique<AVLibVideoDecoder>(source, move(codecContext),
-                    streamIndex, requiredVideo);
+                    streamIndex, requiredVideo, options, onFrameReady);
             case AVMEDIA_TYPE_AUDIO:break;
             case AVMEDIA_TYPE_DATA:break;
             case AVMEDIA_TYPE_SUBTITLE:break;
@@ -166,6 +256,11 @@ namespace UnityAV
         {
             while (_stayAlive.test_and_set())
             {
+                if (_flushRequest.exchange(false))
+                {
+                    OnFlush();
+                }
+
                 auto decode = CanDecodeMore();
 
                 // get packets while the decoder is still ready for more
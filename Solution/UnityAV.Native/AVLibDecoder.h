@@ -3,6 +3,9 @@
 #include "AVLibPacket.h"
 #include "AVLibFrame.h"
 #include "IAVLibSource.h"
+#include "PlayerOptions.h"
+#include "PlayerStatistics.h"
+#include "VideoDescription.h"
 
 using namespace std;
 
@@ -36,16 +39,49 @@ namespace UnityAV
             /**
             * \brief Creates all decoders for the given source
             * \param source The source to create the the decoders for
-            * \param requiredVideo The required video parameters
+            * \param requiredVideo The required video outputs, the first is the primary
+            * \param options The options of the owning player
+            * \param onFrameReady Called by the decoding thread whenever a frame is ready
             * \return A vector of decoders for the source
             */
             static vector<unique_ptr<AVLibDecoder>> Create(IAVLibSource& source,
-                const IVideoDescription& requiredVideo);
+                const vector<VideoDescription>& requiredVideo, 
+                const PlayerOptions& options = PlayerOptions(),
+                function<void()> onFrameReady = nullptr);
             /**
              * \brief Accepts a visit from a IAVLibDecoderVisitor instance
              * \param visitor The visitor to accept
              */
             virtual void Accept(IAVLibDecoderVisitor& visitor) = 0;
+            /**
+             * \brief Evaluates if the decoder serves its frames from memory rather than
+             * from the source, in which case the source need not be seeked
+             * \return True if serving from memory, false otherwise
+             */
+            virtual bool IsServingFromCache() const;
+            /**
+             * \brief Adds the decoders statistics to the given statistics
+             * \param statistics The statistics to add to
+             */
+            virtual void CollectStatistics(PlayerStatistics& statistics) const;
+            /**
+             * \brief Limits how many frames a second the decoder gives, the frames over
+             * the limit are skipped as early as possible
+             * \param framesPerSecond The most frames a second, zero is unlimited
+             */
+            virtual void SetMaxFrameRate(double framesPerSecond);
+            /**
+             * \brief Evaluates if the decoder can carry on decoding its stream of the 
+             * source, which is the case when the stream parameters are unchanged
+             * \param source The source to evaluate against
+             * \return True if the decoder can carry on, false otherwise
+             */
+            bool CanDecode(IAVLibSource& source) const;
+            /**
+             * \brief Requests that the decoder drops its state before decoding the next
+             * packet, for when the stream has been interrupted
+             */
+            void Flush();
 
             /**
             * \brief Evalutes the time base of the stream
@@ -69,9 +105,11 @@ namespace UnityAV
              * \param source The source to get packets from
              * \param codecContext The codec context of the stream
              * \param streamIndex The stream index
+             * \param onFrameReady Called by the decoding thread whenever a frame is ready
              */
             explicit AVLibDecoder(IAVLibSource& source, unique_ptr<AVCodecContext,
-                AVCodecContextDeleter> codecContext, int streamIndex);
+                AVCodecContextDeleter> codecContext, int streamIndex, 
+                function<void()> onFrameReady = nullptr);
 
             /**
             * \brief Evaluates if the decoder can decode more frames
@@ -103,6 +141,11 @@ namespace UnityAV
              * \param to The time to seek to
              */
             virtual void OnSeek(double to) = 0;
+            /**
+             * \brief Drops the decoding state, called on the decoding thread after a 
+             * flush has been requested
+             */
+            virtual void OnFlush();
 
             /**
              * \brief Terminates the decoding thread, must be called in child destructors
@@ -117,6 +160,10 @@ namespace UnityAV
              * \brief Should be called by concrete classes when they need more packets
              */
             void OnNeedMorePackets();
+            /**
+             * \brief Should be called by concrete classes when a frame is ready
+             */
+            void OnFrameReady();
             /**
              * \brief Returns a reference to the AVCodecContext
              * \return A reference to the AVCodecContext
@@ -130,7 +177,8 @@ namespace UnityAV
 
         private:
             static unique_ptr<AVLibDecoder> Create(IAVLibSource& source, int streamIndex,
-                const IVideoDescription& requiredVideo);
+                const vector<VideoDescription>& requiredVideo, const PlayerOptions& options,
+                function<void()> onFrameReady);
             
             void DecodeThread();
             void ContinueDecoding();
@@ -145,12 +193,15 @@ namespace UnityAV
             int _streamIndex;
             double _timeBase, _frameRate, _frameDuration;
             AVLibFrame _avLibFrame;
+            function<void()> _onFrameReady;
+            unique_ptr<AVCodecParameters, AVCodecParametersDeleter> _parameters;
 
             // threading
             thread _thread;
             mutex _continueMutex;
             condition_variable _continue;
             atomic_flag _stayAlive = ATOMIC_FLAG_INIT;
+            atomic_bool _flushRequest;
 
             // meta
             int _successfulDecodes, _failedDecodes;
@@ -9,13 +9,33 @@ namespace UnityAV
         const int AVLibFileSource::DefaultAudioPacketQueueSize = 100;
         const int AVLibFileSource::DefaultSubtitlePacketQueueSize = 50;
         const double AVLibFileSource::SeekThreshold = 0.5;
-
-        AVLibFileSource::AVLibFileSource(string uri) : 
-            _recycler(DefaultVideoPacketQueueSize + DefaultAudioPacketQueueSize +
-            DefaultSubtitlePacketQueueSize), _lowestDTS(INT64_MAX),_lowestPTS(INT64_MAX),
-            _seekStreamIndex(0), _seekTimeBase(0), _seekToTime(0),_seekFromTime(0), 
-            _failedPackets(0), _successfulPackets(0),_skippedPackets(0)
+        const string AVLibFileSource::RTSPPrefix = "rtsp://";
+        const int64_t AVLibFileSource::LiveTimeoutMicroseconds = 5000000;
+        const int64_t AVLibFileSource::LiveMaxDelayMicroseconds = 500000;
+        const int64_t AVLibFileSource::LowLatencyAnalyzeMicroseconds = 500000;
+
+        AVLibFileSource::AVLibFileSource(string uri, const PlayerOptions& options) : 
+            _uri(uri), _options(options), _realtime(uri.compare(0, RTSPPrefix.size(), 
+            RTSPPrefix) == 0), _recycler(DefaultVideoPacketQueueSize + DefaultAudioPacketQueueSize +
+            DefaultSubtitlePacketQueueSize), _listenerDiscontinuity(false),
+            _lowestDTS(INT64_MAX),_lowestPTS(INT64_MAX), _seekStreamIndex(0), _seekTimeBase(0),
+            _seekToTime(0),_seekFromTime(0), _failedPackets(0), _successfulPackets(0),
+            _skippedPackets(0)
         {
+            _connected.store(false);
+            _interrupted.store(false);
+            _eof.store(false);
+            _seekRequest.test_and_set();
+
+            // live media blocks while connecting, so it's opened on the read thread
+            if (_realtime)
+            {
+                _duration = -1;
+                _stayAlive.test_and_set();
+                _thread = thread(&AVLibFileSource::ReadThread, this);
+                return;
+            }
+
             // allocate a format context 
             _formatContext = unique_ptr<AVFormatContext, AVFormatContextDeleter>(
                 avformat_alloc_context());
@@ -30,13 +50,35 @@ namespace UnityAV
             _formatContext->interrupt_callback.callback = BlockingIOInterruptCallback;
             _formatContext->interrupt_callback.opaque = this;
 
+            // read from a shared in-memory copy of the file when requested
+            if (options.CacheInMemory)
+            {
+                auto clip = AVLibMemoryClip::Acquire(uri);
+
+                if (clip)
+                {
+                    _memoryReader = make_unique<AVLibMemoryReader>(move(clip));
+                }
+
+                if (_memoryReader && _memoryReader->Context() != nullptr)
+                {
+                    _formatContext->pb = _memoryReader->Context();
+                    _formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+                }
+                else
+                {
+                    Debug::LogWarning("AVLibFileSource: Could not cache %s in memory, reading from disk", 
+                        uri.c_str());
+                    _memoryReader.reset();
+                }
+            }
+
             // open the file and create the packet queues
             OpenFile(*_formatContext, uri);
             Initialize();
+            _connected.store(true);
 
-            _eof.store(false);            
             _duration = _formatContext->duration * kMicrosecondToSecond;
-            _seekRequest.test_and_set();
 
             // start the reading thread
             _stayAlive.test_and_set();
@@ -45,7 +87,8 @@ namespace UnityAV
 
         AVLibFileSource::~AVLibFileSource()
         {
-            // terminate the running thread
+            // terminate the running thread, aborting any blocking network call
+            _interrupted.store(true);
             _stayAlive.clear();
             _continue.notify_all();
             if(_thread.joinable())
@@ -65,13 +108,16 @@ namespace UnityAV
 
         void AVLibFileSource::Connect()
         {
-            // AVLibFileSource connects in constructor, do nothing
+            // files connect in the constructor, live media retries on the read thread
+            if (_realtime && !_connected.load())
+            {
+                Continue();
+            }
         }
 
         bool AVLibFileSource::IsConnected() const
         {
-            // AVLibFileSource blocks until all are resolved in constructor
-            return true;
+            return _connected.load();
         }
 
         int AVLibFileSource::StreamCount() const
@@ -106,16 +152,22 @@ namespace UnityAV
 
         bool AVLibFileSource::IsRealtime() const
         {
-            return false;
+            return _realtime;
         }
 
         bool AVLibFileSource::CanSeek() const
         {
-            return true;
+            return !_realtime;
         }
 
         void AVLibFileSource::Seek(double from, double to)
         {
+            if (_realtime)
+            {
+                Debug::LogWarning("AVLibFileSource::Seek - live media cannot seek");
+                return;
+            }
+
             _seekFromTime = from;
             _seekToTime = to;
             _seekRequest.clear();
@@ -142,9 +194,44 @@ namespace UnityAV
             _recycler.Recycle(move(packet));
         }
 
+        bool AVLibFileSource::AddProfile(const string& uri, const IVideoDescription& description)
+        {
+            Debug::LogWarning("AVLibFileSource::AddProfile - AVLibFileSource has a single profile");
+            return false;
+        }
+
+        void AVLibFileSource::SetDisplaySize(const IVideoDescription& description)
+        {
+            // do nothing, files have a single profile
+        }
+
+        void AVLibFileSource::SetPaused(bool paused)
+        {
+            // do nothing, files are read as the player's time advances
+        }
+
+        void AVLibFileSource::AddPacketListener(IAVLibPacketListener& listener)
+        {
+            lock_guard<mutex> lock(_listenersMutex);
+
+            if (find(_packetListeners.begin(), _packetListeners.end(), &listener) == 
+                _packetListeners.end())
+            {
+                _packetListeners.push_back(&listener);
+            }
+        }
+
+        void AVLibFileSource::RemovePacketListener(IAVLibPacketListener& listener)
+        {
+            lock_guard<mutex> lock(_listenersMutex);
+
+            _packetListeners.erase(remove(_packetListeners.begin(), _packetListeners.end(), 
+                &listener), _packetListeners.end());
+        }
+
         int AVLibFileSource::BlockingIOInterruptCallback(void* source)
         {
-            return 0;
+            return static_cast<AVLibFileSource*>(source)->_interrupted.load() ? 1 : 0;
         }
 
         bool AVLibFileSource::OpenFile(AVFormatContext& formatContext, string uri)
@@ -174,6 +261,120 @@ namespace UnityAV
             return true;
         }
 
+        bool AVLibFileSource::OpenLive()
+        {
+            auto rawFormatContext = avformat_alloc_context();
+            if (rawFormatContext == nullptr)
+            {
+                Debug::LogError("AVLibFileSource::OpenLive - unable to allocate AVFormatContext");
+                return false;
+            }
+
+            rawFormatContext->interrupt_callback.callback = BlockingIOInterruptCallback;
+            rawFormatContext->interrupt_callback.opaque = this;
+
+            // the format context is freed on failure
+            auto rawOptions = LiveOptions();
+            auto result = avformat_open_input(&rawFormatContext, _uri.c_str(), nullptr, 
+                &rawOptions);
+            av_dict_free(&rawOptions);
+
+            auto formatContext = unique_ptr<AVFormatContext, AVFormatContextDeleter>(
+                rawFormatContext);
+
+            if (result < 0)
+            {
+                auto errbuf = unique_ptr<char[]>(new char[1024]);
+                av_strerror(result, errbuf.get(), 1024);
+                Debug::LogWarning("AVLibFileSource::OpenLive - failed to open %s: %s", 
+                    _uri.c_str(), errbuf.get());
+                return false;
+            }
+
+            result = avformat_find_stream_info(formatContext.get(), nullptr);
+            if (result < 0)
+            {
+                Debug::LogWarning("AVLibFileSource::OpenLive - failed to find the streams of %s",
+                    _uri.c_str());
+                return false;
+            }
+
+            // decoders and listeners carry on with the streams of the first session
+            if (_formatContext == nullptr)
+            {
+                _formatContext = move(formatContext);
+                Initialize();
+            }
+            else if (CanResume(*formatContext))
+            {
+                _formatContext = move(formatContext);
+
+                lock_guard<mutex> lock(_listenersMutex);
+                _listenerDiscontinuity = true;
+            }
+            else
+            {
+                Debug::LogError("AVLibFileSource::OpenLive - the streams of %s changed while "
+                    "reconnecting", _uri.c_str());
+                return false;
+            }
+
+            _eof.store(false);
+            _connected.store(true);
+
+            return true;
+        }
+
+        AVDictionary* AVLibFileSource::LiveOptions() const
+        {
+            auto options = static_cast<AVDictionary*>(nullptr);
+
+            switch (_options.Transport)
+            {
+            case RTSP_TRANSPORT_TCP:
+                av_dict_set(&options, "rtsp_transport", "tcp", 0);
+                break;
+            case RTSP_TRANSPORT_MULTICAST:
+                av_dict_set(&options, "rtsp_transport", "udp_multicast", 0);
+                break;
+            default:
+                av_dict_set(&options, "rtsp_transport", "udp", 0);
+                break;
+            }
+
+            // packets go straight to the decoders, reordering waits at most max_delay
+            av_dict_set_int(&options, "buffer_size", 
+                static_cast<int64_t>(_options.ReceiveBufferKilobytes) * 1024, 0);
+            av_dict_set_int(&options, "max_delay", 
+                _options.LowLatency ? 0 : LiveMaxDelayMicroseconds, 0);
+            av_dict_set(&options, "fflags", "nobuffer", 0);
+            av_dict_set_int(&options, "stimeout", LiveTimeoutMicroseconds, 0);
+
+            if (_options.LowLatency)
+            {
+                av_dict_set_int(&options, "analyzeduration", LowLatencyAnalyzeMicroseconds, 0);
+            }
+
+            return options;
+        }
+
+        bool AVLibFileSource::CanResume(AVFormatContext& formatContext) const
+        {
+            for (auto i = 0; i < _streamIndices.size(); ++i)
+            {
+                auto streamIndex = static_cast<unsigned int>(_streamIndices[i]);
+
+                if (streamIndex >= formatContext.nb_streams ||
+                    formatContext.streams[streamIndex]->codecpar->codec_id != 
+                    _codecParameters[i]->codec_id)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
         void AVLibFileSource::Initialize()
         {
             auto bestIndices = BestStreamIndices(*_formatContext);
@@ -191,10 +392,22 @@ namespace UnityAV
                 _streamIndices.push_back(streamIndex);
                 _streamTypes.push_back(mediaType);           
                 _streams.push_back(*_formatContext->streams[streamIndex]);
+
+                // the stream keeps its own parameters, live media may be reopened
+                _codecParameters.push_back(unique_ptr<AVCodecParameters, 
+                    AVCodecParametersDeleter>(avcodec_parameters_alloc()));
+                avcodec_parameters_copy(_codecParameters.back().get(), 
+                    _formatContext->streams[streamIndex]->codecpar);
+                _streams.back().codecpar = _codecParameters.back().get();
                 _timeBases.push_back(av_q2d(_formatContext->streams[streamIndex]->time_base));
                 _frameRates.push_back(av_q2d(av_guess_frame_rate(_formatContext.get(), 
                     _formatContext->streams[streamIndex], nullptr)));
 
+                // every stream gets a queue so they line up with the stream indices,
+                // inactive queues are never filled
+                auto active = false;
+                auto queueSize = 1;
+
                 switch (mediaType)
                 {
                 case AVMEDIA_TYPE_UNKNOWN: break;
@@ -203,30 +416,27 @@ namespace UnityAV
                     _seekStreamIndex = streamIndex;
                     _seekTimeBase = av_q2d(
                         _formatContext->streams[_seekStreamIndex]->time_base);
-                    _activeQueues.push_back(true);
-                    _queueThresholds.push_back(DefaultVideoPacketQueueSize / 2);
-                    _packetQueues.push_back(FixedSizeQueue<unique_ptr<AVLibPacket>>(
-                        DefaultVideoPacketQueueSize));
+                    active = true;
+                    queueSize = DefaultVideoPacketQueueSize;
                     break;
                 case AVMEDIA_TYPE_AUDIO:
                     // todo: hack video preferencing for now
-                    _activeQueues.push_back(false);
-                    _queueThresholds.push_back(DefaultAudioPacketQueueSize / 2);
-                    //_packetQueues.push_back(FixedSizeQueue<unique_ptr<AVLibPacket>>(
-                    //    DefaultAudioPacketQueueSize));
+                    queueSize = DefaultAudioPacketQueueSize;
                     break;
                 case AVMEDIA_TYPE_DATA: break;
                 case AVMEDIA_TYPE_SUBTITLE:
                     // todo: hack video preferencing for now
-                    _activeQueues.push_back(false);
-                    _queueThresholds.push_back(DefaultSubtitlePacketQueueSize / 2);
-                    //_packetQueues.push_back(FixedSizeQueue<unique_ptr<AVLibPacket>>(
-                    //    DefaultSubtitlePacketQueueSize));
+                    queueSize = DefaultSubtitlePacketQueueSize;
                     break;
                 case AVMEDIA_TYPE_ATTACHMENT: break;
                 case AVMEDIA_TYPE_NB: break;
                 default: break;
                 }
+
+                _activeQueues.push_back(active);
+                _queueThresholds.push_back(queueSize / 2);
+                _packetQueues.push_back(FixedSizeQueue<unique_ptr<AVLibPacket>>(
+                    active ? queueSize : 1));
             }
 
             // stream indices begin at 0
@@ -253,6 +463,17 @@ namespace UnityAV
         {
             while(_stayAlive.test_and_set())
             {
+                // live media is opened here, and reopened after failing when asked to
+                if (_realtime && !_connected.load() && !OpenLive())
+                {
+                    if (!Wait())
+                    {
+                        break;
+                    }
+
+                    continue;
+                }
+
                 auto seekRequest = !_seekRequest.test_and_set();
                 auto read = !AnyQueueFull() && !seekRequest && !_eof;
 
@@ -269,6 +490,7 @@ namespace UnityAV
                     else
                     {
                         UpdateMeta(*packet);
+                        NotifyListeners(packet->Packet());
                         read = QueuePacket(move(packet));
                     }
 
@@ -382,12 +604,26 @@ namespace UnityAV
                     _eof.store(false);
                     FlushQueues();
                     InjectSeekPackets(to);
+
+                    // listeners see the jump in time
+                    lock_guard<mutex> lock(_listenersMutex);
+                    _listenerDiscontinuity = true;
                 }
             }
         }
 
         bool AVLibFileSource::HandleReadError(int error)
         {
+            // live media ending is a dropped connection, the player reconnects it
+            if (_realtime && !_interrupted.load())
+            {
+                Debug::LogWarning("AVLibFileSource::HandleReadError - live media dropped with %d",
+                    error);
+                _failedPackets++;
+                _connected.store(false);
+                return false;
+            }
+
             if (error == AVERROR_EOF)
             {                
                 OnEOF();
@@ -414,6 +650,30 @@ namespace UnityAV
             }
         }
 
+        void AVLibFileSource::NotifyListeners(const AVPacket& packet)
+        {
+            lock_guard<mutex> lock(_listenersMutex);
+
+            if (_packetListeners.empty())
+            {
+                return;
+            }
+
+            // listeners are given the source's stream index, not the container's
+            auto streamIndex = _streamIndicesToInternal[packet.stream_index];
+            if (streamIndex < 0)
+            {
+                return;
+            }
+
+            for (auto i = 0; i < _packetListeners.size(); ++i)
+            {
+                _packetListeners[i]->OnPacket(streamIndex, packet, _listenerDiscontinuity);
+            }
+
+            _listenerDiscontinuity = false;
+        }
+
         bool AVLibFileSource::QueuePacket(unique_ptr<AVLibPacket> packet)
         {
             // find which stream the packet belongs to
@@ -1,6 +1,8 @@
 ﻿#pragma once
 #include "IAVLibSource.h"
 #include "AVLibPacketRecycler.h"
+#include "AVLibMemoryReader.h"
+#include "PlayerOptions.h"
 
 namespace UnityAV
 {
@@ -17,8 +19,9 @@ namespace UnityAV
             /**
              * \brief Initializes a new instance of AVLibFileSource
              * \param uri The uri of the media file to read
+             * \param options The options of the owning player
              */
-            explicit AVLibFileSource(string uri);
+            explicit AVLibFileSource(string uri, const PlayerOptions& options = PlayerOptions());
             // Disabled copy constructor
             explicit AVLibFileSource(const AVLibFileSource&& other) = delete;
             // Disabled copy assignment
@@ -42,16 +45,28 @@ namespace UnityAV
             void Seek(double from, double to) override;
             unique_ptr<AVLibPacket> TryGetNext(int streamIndex) override;
             void Recycle(unique_ptr<AVLibPacket> packet) override;            
+            bool AddProfile(const string& uri, const IVideoDescription& description) override;
+            void SetDisplaySize(const IVideoDescription& description) override;
+            void SetPaused(bool paused) override;
+            void AddPacketListener(IAVLibPacketListener& listener) override;
+            void RemovePacketListener(IAVLibPacketListener& listener) override;
 
         private:
             static const int DefaultVideoPacketQueueSize;
             static const int DefaultAudioPacketQueueSize;
             static const int DefaultSubtitlePacketQueueSize;
             static const double SeekThreshold;
+            static const string RTSPPrefix;
+            static const int64_t LiveTimeoutMicroseconds;
+            static const int64_t LiveMaxDelayMicroseconds;
+            static const int64_t LowLatencyAnalyzeMicroseconds;
 
             static int BlockingIOInterruptCallback(void * source);
             static bool OpenFile(AVFormatContext& formatContext, string uri);            
             
+            bool OpenLive();
+            AVDictionary* LiveOptions() const;
+            bool CanResume(AVFormatContext& formatContext) const;
             void Initialize();
             void ReadThread();
             void Continue();
@@ -60,12 +75,21 @@ namespace UnityAV
             void OnSeekRequest();
             bool HandleReadError(int error);
             void UpdateMeta(AVLibPacket& packet);
+            void NotifyListeners(const AVPacket& packet);
             bool QueuePacket(unique_ptr<AVLibPacket> packet);
             void FlushQueues();
             void InjectSeekPackets(double time);
             bool AnyQueueFull() const;
 
-            // packets
+            // media, live media is opened on the read thread and reopened after failing
+            string _uri;
+            PlayerOptions _options;
+            bool _realtime;
+            atomic_bool _connected;
+            atomic_bool _interrupted;
+
+            // packets, the memory reader must outlive the format context
+            unique_ptr<AVLibMemoryReader> _memoryReader;
             unique_ptr<AVFormatContext, AVFormatContextDeleter> _formatContext;
             vector<FixedSizeQueue<unique_ptr<AVLibPacket>>> _packetQueues;
             AVLibPacketRecycler _recycler;
@@ -77,11 +101,17 @@ namespace UnityAV
             vector<int> _streamIndicesToInternal;
             vector<AVMediaType> _streamTypes;
             vector<AVStream> _streams;
+            vector<unique_ptr<AVCodecParameters, AVCodecParametersDeleter>> _codecParameters;
             vector<double> _timeBases;
             vector<double> _frameRates;
             
             atomic_bool _eof;
 
+            // listeners, given every packet read
+            vector<IAVLibPacketListener*> _packetListeners;
+            bool _listenerDiscontinuity;
+            mutex _listenersMutex;
+
             // seeking
             double _duration;
             atomic_flag _seekRequest = ATOMIC_FLAG_INIT;
@@ -0,0 +1,257 @@
+﻿#include "stdafx.h"
+#include "AVLibIntraDecoderPool.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        const int AVLibIntraDecoderPool::kMaxLanes = 8;
+        const int AVLibIntraDecoderPool::kMaxInFlightPerLane = 2;
+
+        AVLibIntraDecoderPool::AVLibIntraDecoderPool(ConvertCallback convert,
+            ReleaseCallback release) : _convert(move(convert)), _release(move(release)),
+            _nextSequence(0), _nextRelease(0), _generation(0), _stopping(false)
+        {
+
+        }
+
+        AVLibIntraDecoderPool::~AVLibIntraDecoderPool()
+        {
+            {
+                lock_guard<mutex> lock(_mutex);
+                _stopping = true;
+            }
+
+            for (auto i = 0; i < _lanes.size(); ++i)
+            {
+                _lanes[i]->Condition.notify_all();
+            }
+
+            for (auto i = 0; i < _lanes.size(); ++i)
+            {
+                if (_lanes[i]->Thread.joinable())
+                {
+                    _lanes[i]->Thread.join();
+                }
+            }
+        }
+
+        bool AVLibIntraDecoderPool::IsIntraOnly(AVCodecID codecId)
+        {
+            auto descriptor = avcodec_descriptor_get(codecId);
+            return descriptor != nullptr && (descriptor->props & AV_CODEC_PROP_INTRA_ONLY) != 0;
+        }
+
+        int AVLibIntraDecoderPool::DefaultLaneCount()
+        {
+            // leave cores free for the other streams and for converting
+            auto cores = static_cast<int>(thread::hardware_concurrency());
+            return max(1, min(kMaxLanes, cores / 2));
+        }
+
+        unique_ptr<AVLibIntraDecoderPool> AVLibIntraDecoderPool::Create(
+            const AVCodecParameters& parameters, int laneCount, int lowResolution,
+            ConvertCallback convert, ReleaseCallback release)
+        {
+            auto codec = avcodec_find_decoder(parameters.codec_id);
+            if (codec == nullptr)
+            {
+                Debug::LogWarning("AVLibIntraDecoderPool::Create: Could not find codec");
+                return nullptr;
+            }
+
+            auto pool = unique_ptr<AVLibIntraDecoderPool>(new AVLibIntraDecoderPool(
+                move(convert), move(release)));
+
+            for (auto i = 0; i < max(1, min(kMaxLanes, laneCount)); ++i)
+            {
+                auto codecContext = unique_ptr<AVCodecContext, AVCodecContextDeleter>(
+                    avcodec_alloc_context3(nullptr));
+                if (!codecContext ||
+                    avcodec_parameters_to_context(codecContext.get(), &parameters) < 0)
+                {
+                    Debug::LogWarning("AVLibIntraDecoderPool::Create: Could not create codec context");
+                    return nullptr;
+                }
+
+                // the lanes are the threads, each context decodes on its own
+                codecContext->thread_count = 1;
+                codecContext->lowres = lowResolution;
+
+                if (avcodec_open2(codecContext.get(), codec, nullptr) < 0)
+                {
+                    Debug::LogWarning("AVLibIntraDecoderPool::Create: Could not open codec");
+                    return nullptr;
+                }
+
+                auto lane = make_unique<Lane>();
+                lane->CodecContext = move(codecContext);
+                pool->_lanes.push_back(move(lane));
+            }
+
+            for (auto i = 0; i < pool->_lanes.size(); ++i)
+            {
+                pool->_lanes[i]->Thread = thread(&AVLibIntraDecoderPool::LaneThread,
+                    pool.get(), i);
+            }
+
+            return pool;
+        }
+
+        bool AVLibIntraDecoderPool::Submit(const AVPacket& packet)
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            if (_nextSequence - _nextRelease >= kMaxInFlightPerLane * 
+                static_cast<int64_t>(_lanes.size()))
+            {
+                return false;
+            }
+
+            auto job = Job();
+            job.Packet = CreatePacket(packet);
+            if (job.Packet == nullptr)
+            {
+                return false;
+            }
+
+            job.Sequence = _nextSequence++;
+            job.Generation = _generation;
+
+            // consecutive packets go to consecutive lanes
+            auto& lane = *_lanes[job.Sequence % _lanes.size()];
+            lane.Jobs.push_back(move(job));
+            lane.Condition.notify_one();
+
+            return true;
+        }
+
+        bool AVLibIntraDecoderPool::CanSubmit() const
+        {
+            lock_guard<mutex> lock(_mutex);
+            return _nextSequence - _nextRelease < kMaxInFlightPerLane * 
+                static_cast<int64_t>(_lanes.size());
+        }
+
+        void AVLibIntraDecoderPool::SubmitMarker(unique_ptr<VideoFrame> marker)
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            _completed[_nextSequence++] = move(marker);
+            ReleaseInOrder();
+        }
+
+        void AVLibIntraDecoderPool::Flush()
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            // jobs already decoding finish under the old generation and are discarded
+            _generation++;
+            for (auto i = 0; i < _lanes.size(); ++i)
+            {
+                _lanes[i]->Jobs.clear();
+            }
+
+            _completed.clear();
+            _nextRelease = _nextSequence;
+        }
+
+        int AVLibIntraDecoderPool::InFlight() const
+        {
+            lock_guard<mutex> lock(_mutex);
+            return static_cast<int>(_nextSequence - _nextRelease);
+        }
+
+        int AVLibIntraDecoderPool::LaneCount() const
+        {
+            return static_cast<int>(_lanes.size());
+        }
+
+        void AVLibIntraDecoderPool::LaneThread(int laneIndex)
+        {
+            auto& lane = *_lanes[laneIndex];
+
+            while (true)
+            {
+                auto job = Job();
+
+                {
+                    auto lock = unique_lock<mutex>(_mutex);
+                    lane.Condition.wait(lock, [this, &lane]()
+                    {
+                        return _stopping || !lane.Jobs.empty();
+                    });
+
+                    if (_stopping)
+                    {
+                        break;
+                    }
+
+                    job = move(lane.Jobs.front());
+                    lane.Jobs.pop_front();
+                }
+
+                auto frame = Decode(lane, *job.Packet, laneIndex);
+                job.Packet.reset();
+
+                Complete(job.Sequence, job.Generation, move(frame));
+            }
+        }
+
+        unique_ptr<VideoFrame> AVLibIntraDecoderPool::Decode(Lane& lane, AVPacket& packet,
+            int laneIndex)
+        {
+            if (avcodec_send_packet(lane.CodecContext.get(), &packet) < 0)
+            {
+                return nullptr;
+            }
+
+            // intra only codecs give a frame per packet, any more would be out of order
+            auto converted = unique_ptr<VideoFrame>();
+            while (avcodec_receive_frame(lane.CodecContext.get(), &lane.Frame.Frame()) == 0)
+            {
+                if (converted == nullptr)
+                {
+                    converted = _convert(lane.Frame.Frame(), laneIndex);
+                }
+
+                lane.Frame.Clean();
+            }
+
+            return converted;
+        }
+
+        void AVLibIntraDecoderPool::Complete(int64_t sequence, int64_t generation,
+            unique_ptr<VideoFrame> frame)
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            if (generation != _generation)
+            {
+                return;
+            }
+
+            _completed[sequence] = move(frame);
+            ReleaseInOrder();
+        }
+
+        void AVLibIntraDecoderPool::ReleaseInOrder()
+        {
+            // released under the lock so frames are taken one at a time, in order
+            auto it = _completed.find(_nextRelease);
+            while (it != _completed.end())
+            {
+                auto frame = move(it->second);
+                _completed.erase(it);
+                _nextRelease++;
+
+                if (frame != nullptr)
+                {
+                    _release(move(frame));
+                }
+
+                it = _completed.find(_nextRelease);
+            }
+        }
+    }
+}
@@ -0,0 +1,151 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "AVLibFrame.h"
+#include "AVLibPacket.h"
+#include "VideoFrame.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for decoding the packets of an intra only stream, such as
+         * mjpeg, on several codec contexts at once, every frame stands alone so
+         * consecutive packets go to different lanes and the frames are given back in
+         * the order the packets were submitted
+         */
+        class AVLibIntraDecoderPool
+        {
+        public:
+            /**
+             * \brief Converts a decoded frame on the lane which decoded it
+             */
+            typedef function<unique_ptr<VideoFrame>(AVFrame& frame, int lane)> ConvertCallback;
+            /**
+             * \brief Takes the converted frames in submission order, one at a time
+             */
+            typedef function<void(unique_ptr<VideoFrame> frame)> ReleaseCallback;
+
+            /**
+             * \brief Deconstructs an instance of AVLibIntraDecoderPool, the work in
+             * flight is abandoned
+             */
+            virtual ~AVLibIntraDecoderPool();
+            // Disabled copy constructor
+            explicit AVLibIntraDecoderPool(const AVLibIntraDecoderPool&& other) = delete;
+            // Disabled copy assignment
+            AVLibIntraDecoderPool& operator=(const AVLibIntraDecoderPool&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibIntraDecoderPool(AVLibIntraDecoderPool&& other) = delete;
+            // Disabled move assignment
+            AVLibIntraDecoderPool& operator=(AVLibIntraDecoderPool&& other) = delete;
+
+            /**
+             * \brief Evaluates if every frame of a codec can be decoded on its own
+             * \param codecId The codec to evaluate
+             * \return True if the codec is intra only, false otherwise
+             */
+            static bool IsIntraOnly(AVCodecID codecId);
+            /**
+             * \brief Evaluates the number of lanes to use when none is asked for
+             * \return The number of lanes
+             */
+            static int DefaultLaneCount();
+            /**
+             * \brief Creates a pool of codec contexts for a stream
+             * \param parameters The codec parameters of the stream
+             * \param laneCount The number of codec contexts, each with its own thread
+             * \param lowResolution The lowres factor to decode at
+             * \param convert Called on a lane with each frame it decodes
+             * \param release Called with each converted frame in submission order
+             * \return The pool, nullptr on failure
+             */
+            static unique_ptr<AVLibIntraDecoderPool> Create(const AVCodecParameters& parameters,
+                int laneCount, int lowResolution, ConvertCallback convert, 
+                ReleaseCallback release);
+
+            /**
+             * \brief Submits a packet to the next lane, the pool takes its own reference
+             * \param packet The packet to decode
+             * \return True if submitted, false if the lanes were full and the packet was
+             * dropped
+             */
+            bool Submit(const AVPacket& packet);
+            /**
+             * \brief Evaluates if the lanes can take another packet
+             * \return True if another packet can be submitted, false otherwise
+             */
+            bool CanSubmit() const;
+            /**
+             * \brief Submits a frame which is released once every packet before it is
+             * released, such as an eof marker
+             * \param marker The frame to release in order
+             */
+            void SubmitMarker(unique_ptr<VideoFrame> marker);
+            /**
+             * \brief Abandons the work in flight, none of it is released
+             */
+            void Flush();
+            /**
+             * \brief Evaluates the number of packets submitted and not yet released
+             * \return The number of packets in flight
+             */
+            int InFlight() const;
+            /**
+             * \brief Evaluates the number of lanes
+             * \return The number of lanes
+             */
+            int LaneCount() const;
+
+        private:
+            static const int kMaxLanes;
+            static const int kMaxInFlightPerLane;
+
+            /**
+             * \brief A packet waiting on a lane
+             */
+            struct Job
+            {
+                unique_ptr<AVPacket, AVPacketDeleter> Packet;
+                int64_t Sequence;
+                int64_t Generation;
+            };
+
+            /**
+             * \brief A codec context with its own thread and jobs
+             */
+            struct Lane
+            {
+                unique_ptr<AVCodecContext, AVCodecContextDeleter> CodecContext;
+                AVLibFrame Frame;
+                deque<Job> Jobs;
+                condition_variable Condition;
+                thread Thread;
+            };
+
+            explicit AVLibIntraDecoderPool(ConvertCallback convert, ReleaseCallback release);
+
+            void LaneThread(int lane);
+            unique_ptr<VideoFrame> Decode(Lane& lane, AVPacket& packet, int laneIndex);
+            void Complete(int64_t sequence, int64_t generation, unique_ptr<VideoFrame> frame);
+            void ReleaseInOrder();
+
+            // core
+            vector<unique_ptr<Lane>> _lanes;
+            ConvertCallback _convert;
+            ReleaseCallback _release;
+
+            // ordering, a completed sequence without a frame failed to decode
+            unordered_map<int64_t, unique_ptr<VideoFrame>> _completed;
+            int64_t _nextSequence;
+            int64_t _nextRelease;
+            int64_t _generation;
+
+            // threading
+            mutable mutex _mutex;
+            bool _stopping;
+        };
+    }
+}
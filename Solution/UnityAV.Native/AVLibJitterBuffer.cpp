@@ -0,0 +1,103 @@
+﻿#include "stdafx.h"
+#include "AVLibJitterBuffer.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        const int64_t AVLibJitterBuffer::kMaxDelay = 500000;
+        const int64_t AVLibJitterBuffer::kDiscontinuity = 1000000;
+        const int64_t AVLibJitterBuffer::kTransitDrift = 1024;
+        const double AVLibJitterBuffer::kJitterGain = 1.0 / 16.0;
+
+        AVLibJitterBuffer::AVLibJitterBuffer(double factor) : _factor(max(0.0, factor)),
+            _started(false), _lastArrival(0), _lastTime(0), _baseTransit(0), _jitter(0)
+        {
+            _depth.store(0);
+            _lateFrames.store(0);
+        }
+
+        void AVLibJitterBuffer::OnArrival(double time)
+        {
+            auto arrival = av_gettime_relative();
+            auto mediaTime = static_cast<int64_t>(time * kSecondToMicrosecond);
+            auto transit = arrival - mediaTime;
+
+            lock_guard<mutex> lock(_mutex);
+
+            // the presentation times jump when rtcp first synchronises them
+            if (!_started || abs(transit - _baseTransit) > kDiscontinuity)
+            {
+                _started = true;
+                _baseTransit = transit;
+                _jitter = 0;
+            }
+            else
+            {
+                // rfc 3550 interarrival jitter, the deviation of the arrival spacing
+                // from the presentation spacing
+                auto deviation = (arrival - _lastArrival) - (mediaTime - _lastTime);
+                _jitter += (abs(deviation) - _jitter) * kJitterGain;
+
+                // the fastest transit seen is the base, it slowly follows any clock drift
+                if (transit < _baseTransit)
+                {
+                    _baseTransit = transit;
+                }
+                else
+                {
+                    _baseTransit += (transit - _baseTransit) / kTransitDrift;
+                }
+            }
+
+            _lastArrival = arrival;
+            _lastTime = mediaTime;
+        }
+
+        bool AVLibJitterBuffer::IsDue(double time) const
+        {
+            auto mediaTime = static_cast<int64_t>(time * kSecondToMicrosecond);
+            lock_guard<mutex> lock(_mutex);
+
+            if (!_started)
+            {
+                return true;
+            }
+
+            return av_gettime_relative() >= mediaTime + _baseTransit + TargetDelay();
+        }
+
+        void AVLibJitterBuffer::OnLate()
+        {
+            _lateFrames++;
+        }
+
+        void AVLibJitterBuffer::SetDepth(int depth)
+        {
+            _depth.store(depth);
+        }
+
+        void AVLibJitterBuffer::Reset()
+        {
+            lock_guard<mutex> lock(_mutex);
+            _started = false;
+            _jitter = 0;
+        }
+
+        void AVLibJitterBuffer::CollectStatistics(PlayerStatistics& statistics) const
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            statistics.JitterBufferDepth += _depth.load();
+            statistics.LateFrames += _lateFrames.load();
+            statistics.JitterMilliseconds = max(statistics.JitterMilliseconds, _jitter / 1000.0);
+            statistics.JitterBufferDelayMilliseconds = max(
+                statistics.JitterBufferDelayMilliseconds, TargetDelay() / 1000.0);
+        }
+
+        int64_t AVLibJitterBuffer::TargetDelay() const
+        {
+            return min(kMaxDelay, static_cast<int64_t>(_jitter * _factor));
+        }
+    }
+}
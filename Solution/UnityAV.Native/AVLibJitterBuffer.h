@@ -0,0 +1,88 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "PlayerStatistics.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for scheduling the presentation of live frames by their
+         * presentation time, frames are held back by a delay which adapts to the
+         * measured interarrival jitter (rfc 3550) so network jitter doesn't become judder
+         */
+        class AVLibJitterBuffer
+        {
+        public:
+            // Default destructor
+            virtual ~AVLibJitterBuffer(){}
+            /**
+             * \brief Initializes a new instance of AVLibJitterBuffer
+             * \param factor The multiple of the measured jitter to delay frames by, zero
+             * favours latency while larger values favour smoothness
+             */
+            explicit AVLibJitterBuffer(double factor);
+            // Disabled copy constructor
+            explicit AVLibJitterBuffer(const AVLibJitterBuffer&& other) = delete;
+            // Disabled copy assignment
+            AVLibJitterBuffer& operator=(const AVLibJitterBuffer&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibJitterBuffer(AVLibJitterBuffer&& other) = delete;
+            // Disabled move assignment
+            AVLibJitterBuffer& operator=(AVLibJitterBuffer&& other) = delete;
+
+            /**
+             * \brief Records the arrival of a frame, called as frames are decoded
+             * \param time The presentation time of the frame in seconds
+             */
+            void OnArrival(double time);
+            /**
+             * \brief Evaluates if a frame is due to be presented
+             * \param time The presentation time of the frame in seconds
+             * \return True if the frame is due, false otherwise
+             */
+            bool IsDue(double time) const;
+            /**
+             * \brief Records that a due frame was dropped for a newer due frame
+             */
+            void OnLate();
+            /**
+             * \brief Records the number of frames waiting to be presented
+             * \param depth The number of frames waiting
+             */
+            void SetDepth(int depth);
+            /**
+             * \brief Forgets the timing of the stream, for when it restarts
+             */
+            void Reset();
+            /**
+             * \brief Adds the jitter buffer's statistics to the given statistics
+             * \param statistics The statistics to add to
+             */
+            void CollectStatistics(PlayerStatistics& statistics) const;
+
+        private:
+            static const int64_t kMaxDelay;
+            static const int64_t kDiscontinuity;
+            static const int64_t kTransitDrift;
+            static const double kJitterGain;
+
+            int64_t TargetDelay() const;
+
+            // core
+            double _factor;
+            bool _started;
+            int64_t _lastArrival;
+            int64_t _lastTime;
+            int64_t _baseTransit;
+            double _jitter;
+            mutable mutex _mutex;
+
+            // meta
+            atomic_int _depth;
+            atomic<int64_t> _lateFrames;
+        };
+    }
+}
@@ -0,0 +1,82 @@
+﻿#include "stdafx.h"
+#include "AVLibMemoryClip.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        mutex AVLibMemoryClip::CacheMutex;
+        unordered_map<string, weak_ptr<AVLibMemoryClip>> AVLibMemoryClip::Cache;
+
+        AVLibMemoryClip::AVLibMemoryClip(vector<uint8_t> data) : _data(move(data))
+        {
+
+        }
+
+        shared_ptr<AVLibMemoryClip> AVLibMemoryClip::Acquire(const string& uri)
+        {
+            lock_guard<mutex> lock(CacheMutex);
+
+            // reuse the clip if anyone is still holding it
+            auto it = Cache.find(uri);
+            if (it != Cache.end())
+            {
+                auto clip = it->second.lock();
+
+                if (clip)
+                {
+                    return clip;
+                }
+            }
+
+            auto clip = Load(uri);
+
+            if (clip)
+            {
+                Cache[uri] = clip;
+            }
+            else
+            {
+                Cache.erase(uri);
+            }
+
+            return clip;
+        }
+
+        const uint8_t* AVLibMemoryClip::Data() const
+        {
+            return _data.data();
+        }
+
+        int64_t AVLibMemoryClip::Size() const
+        {
+            return static_cast<int64_t>(_data.size());
+        }
+
+        shared_ptr<AVLibMemoryClip> AVLibMemoryClip::Load(const string& uri)
+        {
+            ifstream stream(uri, ios::binary | ios::ate);
+
+            if (!stream.good())
+            {
+                Debug::LogError("AVLibMemoryClip::Load: Could not open %s", uri.c_str());
+                return nullptr;
+            }
+
+            auto size = static_cast<size_t>(stream.tellg());
+            auto data = vector<uint8_t>(size);
+
+            stream.seekg(0, ios::beg);
+            if (!stream.read(reinterpret_cast<char*>(data.data()), size))
+            {
+                Debug::LogError("AVLibMemoryClip::Load: Could not read %s", uri.c_str());
+                return nullptr;
+            }
+
+            Debug::Log("AVLibMemoryClip::Load: Loaded %d bytes of %s into memory",
+                static_cast<int>(size), uri.c_str());
+
+            return shared_ptr<AVLibMemoryClip>(new AVLibMemoryClip(move(data)));
+        }
+    }
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for holding the compressed contents of a media file in
+         * memory, a single instance is shared across all users of the same uri
+         */
+        class AVLibMemoryClip
+        {
+        public:
+            // Default destructor
+            virtual ~AVLibMemoryClip(){}
+            // Disabled copy constructor
+            explicit AVLibMemoryClip(const AVLibMemoryClip&& other) = delete;
+            // Disabled copy assignment
+            AVLibMemoryClip& operator=(const AVLibMemoryClip&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibMemoryClip(AVLibMemoryClip&& other) = delete;
+            // Disabled move assignment
+            AVLibMemoryClip& operator=(AVLibMemoryClip&& other) = delete;
+
+            /**
+             * \brief Acquires the clip for a uri, loading it from disk only if no other
+             * user currently holds it
+             * \param uri The uri of the media file to acquire
+             * \return The shared clip, nullptr on failure
+             */
+            static shared_ptr<AVLibMemoryClip> Acquire(const string& uri);
+
+            /**
+             * \brief Exposes the contents of the clip
+             * \return A pointer to the contents of the clip
+             */
+            const uint8_t* Data() const;
+            /**
+             * \brief Evaluates the size of the clip
+             * \return The size of the clip in bytes
+             */
+            int64_t Size() const;
+
+        private:
+            static mutex CacheMutex;
+            static unordered_map<string, weak_ptr<AVLibMemoryClip>> Cache;
+
+            static shared_ptr<AVLibMemoryClip> Load(const string& uri);
+
+            /**
+             * \brief Initializes a new instance of AVLibMemoryClip
+             * \param data The contents of the clip, will take ownership
+             */
+            explicit AVLibMemoryClip(vector<uint8_t> data);
+
+            vector<uint8_t> _data;
+        };
+    }
+}
@@ -0,0 +1,91 @@
+﻿#include "stdafx.h"
+#include "AVLibMemoryReader.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        const int AVLibMemoryReader::DefaultBufferSize = 32768;
+
+        AVLibMemoryReader::AVLibMemoryReader(shared_ptr<AVLibMemoryClip> clip)
+            : _clip(move(clip)), _position(0)
+        {
+            // avlib takes ownership of the buffer and may reallocate it
+            auto buffer = static_cast<uint8_t*>(av_malloc(DefaultBufferSize));
+
+            if (buffer == nullptr)
+            {
+                Debug::LogError("AVLibMemoryReader: Unable to allocate io buffer");
+                return;
+            }
+
+            _context = unique_ptr<AVIOContext, AVIOContextDeleter>(avio_alloc_context(
+                buffer, DefaultBufferSize, 0, this, Read, nullptr, Seek));
+
+            if (!_context)
+            {
+                av_free(buffer);
+                Debug::LogError("AVLibMemoryReader: Unable to allocate AVIOContext");
+            }
+        }
+
+        AVIOContext* AVLibMemoryReader::Context()
+        {
+            return _context.get();
+        }
+
+        int AVLibMemoryReader::Read(void* rawReader, uint8_t* buffer, int size)
+        {
+            auto reader = static_cast<AVLibMemoryReader*>(rawReader);
+            auto remaining = reader->_clip->Size() - reader->_position;
+
+            if (remaining <= 0)
+            {
+                return AVERROR_EOF;
+            }
+
+            auto count = static_cast<int>(min(static_cast<int64_t>(size), remaining));
+            memcpy(buffer, reader->_clip->Data() + reader->_position, count);
+            reader->_position += count;
+
+            return count;
+        }
+
+        int64_t AVLibMemoryReader::Seek(void* rawReader, int64_t offset, int whence)
+        {
+            auto reader = static_cast<AVLibMemoryReader*>(rawReader);
+            auto size = reader->_clip->Size();
+
+            // avlib asks for the size without seeking
+            if (whence & AVSEEK_SIZE)
+            {
+                return size;
+            }
+
+            int64_t position;
+            switch (whence & ~AVSEEK_FORCE)
+            {
+            case SEEK_SET:
+                position = offset;
+                break;
+            case SEEK_CUR:
+                position = reader->_position + offset;
+                break;
+            case SEEK_END:
+                position = size + offset;
+                break;
+            default:
+                return AVERROR(EINVAL);
+            }
+
+            if (position < 0 || position > size)
+            {
+                return AVERROR(EINVAL);
+            }
+
+            reader->_position = position;
+
+            return position;
+        }
+    }
+}
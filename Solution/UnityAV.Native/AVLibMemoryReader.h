@@ -0,0 +1,52 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "AVLibMemoryClip.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for exposing an AVLibMemoryClip to avlib through an
+         * AVIOContext, each reader keeps its own read position
+         */
+        class AVLibMemoryReader
+        {
+        public:
+            // Default destructor
+            virtual ~AVLibMemoryReader(){}
+            /**
+             * \brief Initializes a new instance of AVLibMemoryReader
+             * \param clip The clip to read from
+             */
+            explicit AVLibMemoryReader(shared_ptr<AVLibMemoryClip> clip);
+            // Disabled copy constructor
+            explicit AVLibMemoryReader(const AVLibMemoryReader&& other) = delete;
+            // Disabled copy assignment
+            AVLibMemoryReader& operator=(const AVLibMemoryReader&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibMemoryReader(AVLibMemoryReader&& other) = delete;
+            // Disabled move assignment
+            AVLibMemoryReader& operator=(AVLibMemoryReader&& other) = delete;
+
+            /**
+             * \brief Returns the AVIOContext reading from the clip, must outlive any
+             * AVFormatContext it is given to
+             * \return The AVIOContext reading from the clip, nullptr on failure
+             */
+            AVIOContext* Context();
+
+        private:
+            static const int DefaultBufferSize;
+
+            static int Read(void* reader, uint8_t* buffer, int size);
+            static int64_t Seek(void* reader, int64_t offset, int whence);
+
+            shared_ptr<AVLibMemoryClip> _clip;
+            unique_ptr<AVIOContext, AVIOContextDeleter> _context;
+            int64_t _position;
+        };
+    }
+}
@@ -7,18 +7,6 @@ namespace UnityAV
 {
     namespace Media
     {
-        /**
-        * \brief Responsible for deletion of AVPacket instances
-        */
-        struct AVPacketDeleter
-        {
-            void operator()(AVPacket* packet)
-            {
-                av_packet_unref(packet);
-                free(packet);
-            }
-        };
-
         /**
          * \brief Responsible for wrapping an AVPacket instance
          */
@@ -0,0 +1,468 @@
+﻿#include "stdafx.h"
+#include "AVLibPacketRing.h"
+
+// spill files outgrow a 32 bit offset, msvc and posix name the 64 bit seek differently
+#ifndef _MSC_VER
+#define _fseeki64 fseeko
+#endif
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        AVLibPacketRing::~AVLibPacketRing()
+        {
+            {
+                lock_guard<mutex> lock(_mutex);
+                _stopping = true;
+            }
+
+            _writeCondition.notify_all();
+
+            if (_writer.joinable())
+            {
+                _writer.join();
+            }
+
+            if (_spillFile != nullptr)
+            {
+                // temporary files are deleted once closed
+                fclose(_spillFile);
+            }
+        }
+
+        AVLibPacketRing::AVLibPacketRing(int64_t maxDuration, int64_t maxMemory, int64_t maxSpill)
+            : _heldSequence(0), _heldBytes(0), _spillFile(nullptr), _spillFailed(false),
+            _spilledSequence(0), _spillOffset(0), _maxDuration(maxDuration),
+            _maxMemory(maxMemory), _maxSpill(maxSpill), _newestTime(-1), _unwrittenBytes(0),
+            _stopping(false)
+        {
+            if (_maxSpill > 0)
+            {
+                _spillFile = tmpfile();
+
+                if (_spillFile == nullptr)
+                {
+                    Debug::LogWarning("AVLibPacketRing - unable to create a spill file, packets "
+                        "are kept in memory only");
+                }
+                else
+                {
+                    _writer = thread(&AVLibPacketRing::WriterThread, this);
+                }
+            }
+        }
+
+        void AVLibPacketRing::Push(unique_ptr<AVPacket, AVPacketDeleter> packet, bool discontinuity)
+        {
+            if (packet == nullptr)
+            {
+                Debug::LogError("AVLibPacketRing::Push - packet was nullptr");
+                return;
+            }
+
+            lock_guard<mutex> lock(_mutex);
+
+            auto sequence = _heldSequence + static_cast<int64_t>(_held.size());
+            if (packet->flags & AV_PKT_FLAG_KEY)
+            {
+                _keyframes.push_back(make_pair(packet->pts, sequence));
+            }
+
+            _newestTime = max(_newestTime, packet->pts);
+            _heldBytes += packet->size;
+            _held.push_back({ move(packet), discontinuity });
+
+            Trim();
+        }
+
+        bool AVLibPacketRing::TryGet(int streamIndex, int64_t& sequence, AVPacket& packet,
+            bool& discontinuity)
+        {
+            auto lock = unique_lock<mutex>(_mutex);
+            auto skipped = false;
+
+            while (true)
+            {
+                // packets dropped from under the reader leave a gap in its stream
+                skipped |= sequence < FirstSequence();
+                sequence = max(sequence, FirstSequence());
+
+                auto end = _heldSequence + static_cast<int64_t>(_held.size());
+                for (; sequence < end; ++sequence)
+                {
+                    auto packetStream = sequence < _heldSequence ?
+                        _spilled[static_cast<size_t>(sequence - _spilledSequence)].StreamIndex :
+                        _held[static_cast<size_t>(sequence - _heldSequence)].Packet->stream_index;
+
+                    if (streamIndex < 0 || packetStream == streamIndex)
+                    {
+                        break;
+                    }
+                }
+
+                if (sequence >= end)
+                {
+                    return false;
+                }
+
+                if (sequence >= _heldSequence)
+                {
+                    auto& held = _held[static_cast<size_t>(sequence - _heldSequence)];
+                    discontinuity = held.Discontinuity || skipped;
+                    return av_packet_ref(&packet, held.Packet.get()) == 0;
+                }
+
+                auto spilled = _spilled[static_cast<size_t>(sequence - _spilledSequence)];
+                discontinuity = spilled.Discontinuity || skipped;
+
+                if (spilled.Unwritten != nullptr)
+                {
+                    return av_packet_ref(&packet, spilled.Unwritten.get()) == 0;
+                }
+
+                // the file is read without holding the ring, so pushes never wait on it
+                lock.unlock();
+                auto read = ReadSpilled(spilled, packet);
+                lock.lock();
+
+                // a packet dropped while it was read may have been overwritten meanwhile
+                if (read && sequence >= FirstSequence())
+                {
+                    return true;
+                }
+
+                if (read)
+                {
+                    av_packet_unref(&packet);
+                }
+                else
+                {
+                    // an unreadable packet is skipped like a dropped one
+                    sequence++;
+                }
+
+                skipped = true;
+            }
+        }
+
+        int64_t AVLibPacketRing::FindKeyframe(int64_t time) const
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            if (_keyframes.empty())
+            {
+                return -1;
+            }
+
+            for (auto keyframe = _keyframes.rbegin(); keyframe != _keyframes.rend(); ++keyframe)
+            {
+                if (keyframe->first <= time)
+                {
+                    return keyframe->second;
+                }
+            }
+
+            return _keyframes.front().second;
+        }
+
+        int64_t AVLibPacketRing::FindAfter(int streamIndex, int64_t time) const
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            // readers look for the recent past, so search back from the newest
+            auto end = _heldSequence + static_cast<int64_t>(_held.size());
+            auto found = end;
+
+            for (auto sequence = end - 1; sequence >= FirstSequence(); --sequence)
+            {
+                auto packetStream = sequence < _heldSequence ?
+                    _spilled[static_cast<size_t>(sequence - _spilledSequence)].StreamIndex :
+                    _held[static_cast<size_t>(sequence - _heldSequence)].Packet->stream_index;
+
+                if (packetStream != streamIndex)
+                {
+                    continue;
+                }
+
+                if (TimeOfSequence(sequence) <= time)
+                {
+                    break;
+                }
+
+                found = sequence;
+            }
+
+            return found;
+        }
+
+        int64_t AVLibPacketRing::TimeOf(int64_t sequence) const
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            auto end = _heldSequence + static_cast<int64_t>(_held.size());
+            if (sequence < FirstSequence() || sequence >= end)
+            {
+                return -1;
+            }
+
+            return TimeOfSequence(sequence);
+        }
+
+        int64_t AVLibPacketRing::OldestTime() const
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            if (_held.empty() && _spilled.empty())
+            {
+                return -1;
+            }
+
+            return TimeOfSequence(FirstSequence());
+        }
+
+        int64_t AVLibPacketRing::NewestTime() const
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            if (_held.empty() && _spilled.empty())
+            {
+                return -1;
+            }
+
+            return _newestTime;
+        }
+
+        int64_t AVLibPacketRing::Count() const
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            return _heldSequence + static_cast<int64_t>(_held.size()) - FirstSequence();
+        }
+
+        void AVLibPacketRing::Clear()
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            _heldSequence += static_cast<int64_t>(_held.size());
+            _held.clear();
+            _heldBytes = 0;
+            _spilled.clear();
+            _spilledSequence = _heldSequence;
+            _spillOffset = 0;
+            _keyframes.clear();
+            _newestTime = -1;
+        }
+
+        void AVLibPacketRing::Trim()
+        {
+            // packets over the memory budget move to the spill file, or are dropped
+            while (_heldBytes > _maxMemory && _held.size() > 1)
+            {
+                if (_spillFile != nullptr && !_spillFailed)
+                {
+                    Spill(_held.front());
+                }
+                else
+                {
+                    DropOldest();
+                }
+            }
+
+            while (!_held.empty() && _newestTime - TimeOfSequence(FirstSequence()) > _maxDuration)
+            {
+                DropOldest();
+            }
+
+            // playback can only start from a keyframe, so the ring always starts on one
+            while (!_keyframes.empty() && FirstSequence() < _keyframes.front().second)
+            {
+                DropOldest();
+            }
+        }
+
+        void AVLibPacketRing::DropOldest()
+        {
+            if (!_spilled.empty())
+            {
+                _spilled.pop_front();
+                _spilledSequence++;
+            }
+            else if (!_held.empty())
+            {
+                _heldBytes -= _held.front().Packet->size;
+                _held.pop_front();
+                _heldSequence++;
+                _spilledSequence = _heldSequence;
+            }
+
+            while (!_keyframes.empty() && _keyframes.front().second < FirstSequence())
+            {
+                _keyframes.pop_front();
+            }
+        }
+
+        void AVLibPacketRing::Spill(HeldPacket& held)
+        {
+            auto& packet = *held.Packet;
+
+            // packets waiting to be written are still in memory, so a writer which has
+            // fallen behind can't take any more
+            if (!_spillFailed && packet.size <= _maxSpill && _unwrittenBytes < _maxMemory)
+            {
+                // the tail of the file beyond the write position holds the oldest
+                // packets, wrapping overwrites it first
+                if (_spillOffset + packet.size > _maxSpill)
+                {
+                    while (!_spilled.empty() && _spilled.front().Offset >= _spillOffset)
+                    {
+                        DropOldest();
+                    }
+
+                    _spillOffset = 0;
+                }
+
+                auto overlaps = [&](const SpilledPacket& spilled)
+                {
+                    return spilled.Offset < _spillOffset + packet.size &&
+                        _spillOffset < spilled.Offset + spilled.Size;
+                };
+
+                while (!_spilled.empty() && overlaps(_spilled.front()))
+                {
+                    DropOldest();
+                }
+
+                // the writer thread writes it, it's read from memory until then
+                auto size = packet.size;
+                auto unwritten = shared_ptr<AVPacket>(held.Packet.release(), AVPacketDeleter());
+
+                _spilled.push_back({ _spillOffset, size, unwritten->pts,
+                    unwritten->stream_index, (unwritten->flags & AV_PKT_FLAG_KEY) != 0,
+                    held.Discontinuity, unwritten });
+                _spillWrites.push_back({ _heldSequence, _spillOffset, unwritten });
+                _spillOffset += size;
+                _unwrittenBytes += size;
+
+                _heldBytes -= size;
+                _held.pop_front();
+                _heldSequence++;
+
+                _writeCondition.notify_one();
+                return;
+            }
+
+            // the packet can't be spilled, so it and everything older is dropped
+            while (!_spilled.empty())
+            {
+                DropOldest();
+            }
+
+            DropOldest();
+        }
+
+        bool AVLibPacketRing::ReadSpilled(const SpilledPacket& spilled, AVPacket& packet)
+        {
+            if (_spillFile == nullptr || av_new_packet(&packet, spilled.Size) < 0)
+            {
+                return false;
+            }
+
+            auto read = false;
+            {
+                lock_guard<mutex> fileLock(_fileMutex);
+                read = _fseeki64(_spillFile, spilled.Offset, SEEK_SET) == 0 &&
+                    fread(packet.data, 1, spilled.Size, _spillFile) == 
+                    static_cast<size_t>(spilled.Size);
+            }
+
+            if (!read)
+            {
+                Debug::LogError("AVLibPacketRing::ReadSpilled - failed to read the spill file");
+                av_packet_unref(&packet);
+                return false;
+            }
+
+            packet.pts = spilled.Time;
+            packet.stream_index = spilled.StreamIndex;
+            packet.flags = spilled.Keyframe ? AV_PKT_FLAG_KEY : 0;
+
+            return true;
+        }
+
+        void AVLibPacketRing::WriterThread()
+        {
+            while (true)
+            {
+                auto write = SpillWrite();
+
+                {
+                    auto lock = unique_lock<mutex>(_mutex);
+                    _writeCondition.wait(lock, [this]()
+                    {
+                        return _stopping || !_spillWrites.empty();
+                    });
+
+                    if (_stopping)
+                    {
+                        break;
+                    }
+
+                    write = move(_spillWrites.front());
+                    _spillWrites.pop_front();
+                }
+
+                auto size = write.Packet->size;
+                auto written = false;
+                {
+                    lock_guard<mutex> fileLock(_fileMutex);
+                    written = _fseeki64(_spillFile, write.Offset, SEEK_SET) == 0 &&
+                        fwrite(write.Packet->data, 1, size, _spillFile) == 
+                        static_cast<size_t>(size);
+                }
+
+                lock_guard<mutex> lock(_mutex);
+                _unwrittenBytes -= size;
+
+                // packets already spilled stay readable from memory, no more are spilled
+                if (!written)
+                {
+                    if (!_spillFailed)
+                    {
+                        Debug::LogWarning("AVLibPacketRing::WriterThread - failed to write the "
+                            "spill file, packets are kept in memory only");
+                        _spillFailed = true;
+                    }
+
+                    continue;
+                }
+
+                // the packet is read from the file from now on, unless it has been dropped
+                if (write.Sequence >= _spilledSequence && write.Sequence - _spilledSequence <
+                    static_cast<int64_t>(_spilled.size()))
+                {
+                    auto& spilled = _spilled[static_cast<size_t>(write.Sequence - _spilledSequence)];
+                    if (spilled.Unwritten == write.Packet)
+                    {
+                        spilled.Unwritten.reset();
+                    }
+                }
+            }
+        }
+
+        int64_t AVLibPacketRing::FirstSequence() const
+        {
+            return _spilled.empty() ? _heldSequence : _spilledSequence;
+        }
+
+        int64_t AVLibPacketRing::TimeOfSequence(int64_t sequence) const
+        {
+            if (sequence < _heldSequence)
+            {
+                return _spilled[static_cast<size_t>(sequence - _spilledSequence)].Time;
+            }
+
+            return _held[static_cast<size_t>(sequence - _heldSequence)].Packet->pts;
+        }
+    }
+}
@@ -0,0 +1,175 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "AVLibPacket.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for keeping a bounded window of compressed packets from a
+         * live source, indexed by keyframe so playback can be resumed from any point in
+         * the window, packets pushed out of memory may spill into a temporary file,
+         * which is written on a thread of its own so pushing never waits on the disk
+         */
+        class AVLibPacketRing
+        {
+        public:
+            // Default destructor
+            virtual ~AVLibPacketRing();
+            /**
+             * \brief Initializes a new instance of AVLibPacketRing
+             * \param maxDuration The span of media kept in microseconds
+             * \param maxMemory The bytes of packets kept in memory
+             * \param maxSpill The bytes of packets kept in the spill file, zero keeps
+             * packets in memory only
+             */
+            explicit AVLibPacketRing(int64_t maxDuration, int64_t maxMemory, int64_t maxSpill);
+            // Disabled copy constructor
+            explicit AVLibPacketRing(const AVLibPacketRing&& other) = delete;
+            // Disabled copy assignment
+            AVLibPacketRing& operator=(const AVLibPacketRing&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibPacketRing(AVLibPacketRing&& other) = delete;
+            // Disabled move assignment
+            AVLibPacketRing& operator=(AVLibPacketRing&& other) = delete;
+
+            /**
+             * \brief Adds a packet to the newest end of the ring, the oldest packets are
+             * dropped a group of pictures at a time once the ring is full
+             * \param packet The packet to add, its stream index, pts in microseconds and
+             * keyframe flag must be set, keyframes are only flagged on video streams
+             * \param discontinuity True if data was lost ahead of the packet
+             */
+            void Push(unique_ptr<AVPacket, AVPacketDeleter> packet, bool discontinuity);
+            /**
+             * \brief Finds the next packet of a stream in the ring, spilled packets are
+             * read from the file without holding up pushes
+             * \param streamIndex The stream to find the packet of, -1 for any stream
+             * \param sequence The sequence number to search from, set to the sequence
+             * number of the packet found
+             * \param packet The packet to reference the found packet's data into
+             * \param discontinuity Set to true if the packet can't be decoded from the
+             * previous packet of the stream, as packets were dropped or unreadable
+             * \return True if a packet was found, false if the stream has no newer packet
+             */
+            bool TryGet(int streamIndex, int64_t& sequence, AVPacket& packet,
+                bool& discontinuity);
+            /**
+             * \brief Finds the newest keyframe at or before a time
+             * \param time The time in microseconds
+             * \return The sequence number of the keyframe, the oldest keyframe if the time
+             * is older, -1 if the ring holds no keyframes
+             */
+            int64_t FindKeyframe(int64_t time) const;
+            /**
+             * \brief Finds the first packet of a stream after a time
+             * \param streamIndex The stream to find the packet of
+             * \param time The time in microseconds
+             * \return The sequence number of the packet, the end of the ring if none
+             */
+            int64_t FindAfter(int streamIndex, int64_t time) const;
+            /**
+             * \brief Evaluates the presentation time of a packet in the ring
+             * \param sequence The sequence number of the packet
+             * \return The presentation time in microseconds, -1 if no longer held
+             */
+            int64_t TimeOf(int64_t sequence) const;
+            /**
+             * \brief Evaluates the oldest presentation time held
+             * \return The oldest presentation time in microseconds, -1 if empty
+             */
+            int64_t OldestTime() const;
+            /**
+             * \brief Evaluates the newest presentation time held
+             * \return The newest presentation time in microseconds, -1 if empty
+             */
+            int64_t NewestTime() const;
+            /**
+             * \brief Evaluates the number of packets held
+             * \return The number of packets held
+             */
+            int64_t Count() const;
+            /**
+             * \brief Drops every packet held
+             */
+            void Clear();
+
+        private:
+            /**
+             * \brief A packet which has been written to the spill file
+             */
+            struct SpilledPacket
+            {
+                int64_t Offset;
+                int Size;
+                int64_t Time;
+                int StreamIndex;
+                bool Keyframe;
+                bool Discontinuity;
+                // the packet itself until it has been written, it's read from here till then
+                shared_ptr<AVPacket> Unwritten;
+            };
+
+            /**
+             * \brief A spilled packet waiting to be written to the spill file
+             */
+            struct SpillWrite
+            {
+                int64_t Sequence;
+                int64_t Offset;
+                shared_ptr<AVPacket> Packet;
+            };
+
+            /**
+             * \brief A packet held in memory
+             */
+            struct HeldPacket
+            {
+                unique_ptr<AVPacket, AVPacketDeleter> Packet;
+                bool Discontinuity;
+            };
+
+            void Trim();
+            void DropOldest();
+            void Spill(HeldPacket& held);
+            bool ReadSpilled(const SpilledPacket& spilled, AVPacket& packet);
+            void WriterThread();
+            int64_t FirstSequence() const;
+            int64_t TimeOfSequence(int64_t sequence) const;
+
+            // memory, the newest packets, spilled packets directly precede them
+            deque<HeldPacket> _held;
+            int64_t _heldSequence;
+            int64_t _heldBytes;
+
+            // spill file, written as a ring so the oldest packets are overwritten
+            FILE* _spillFile;
+            bool _spillFailed;
+            deque<SpilledPacket> _spilled;
+            int64_t _spilledSequence;
+            int64_t _spillOffset;
+
+            // keyframe index, sequence numbers of video keyframes by time
+            deque<pair<int64_t, int64_t>> _keyframes;
+
+            // limits
+            int64_t _maxDuration;
+            int64_t _maxMemory;
+            int64_t _maxSpill;
+            int64_t _newestTime;
+
+            mutable mutex _mutex;
+
+            // writing, the file is only written and read without holding the ring
+            deque<SpillWrite> _spillWrites;
+            int64_t _unwrittenBytes;
+            thread _writer;
+            condition_variable _writeCondition;
+            bool _stopping;
+            mutex _fileMutex;
+        };
+    }
+}
@@ -2,39 +2,46 @@
 #include "AVLibPlayer.h"
 #include "AVLibVideoDecoder.h"
 #include "AVLibRTSPSource.h"
+#include "AVLibScalingVideoClient.h"
 
 namespace UnityAV
 {
     namespace Media
     {
-        const int AVLibPlayer::ConnectRetryMilliseconds = 2500;
+        const int AVLibPlayer::PlaylistConnectRetryMilliseconds = 2500;
+        const int64_t AVLibPlayer::RealtimeSleepMicroseconds = 10000;
+        const int64_t AVLibPlayer::InitialReconnectMicroseconds = 100000;
+        const int64_t AVLibPlayer::MaxReconnectMicroseconds = 5000000;
+        const int AVLibPlayer::ConnectPollMilliseconds = 10;
+        const int64_t AVLibPlayer::kBytesPerMegabyte = 1024 * 1024;
         atomic_flag AVLibPlayer::ProcessWideInitialized = ATOMIC_FLAG_INIT;
 
-        AVLibPlayer::AVLibPlayer(const string& uri, unique_ptr<IVideoClient> client)
-            : Player(uri, move(client)), _time(0), _lastTime(0), _sleepTime(0)
+        AVLibPlayer::AVLibPlayer(const string& uri, unique_ptr<IVideoClient> client,
+            const PlayerOptions& options) : Player(uri, move(client)), _time(0), _lastTime(0),
+            _sleepTime(0), _options(options)
         {
             // initialize avlib across the process
             ProcessWideInitialize();
 
             // create an appropriate source
-            if (uri.find(RTSPPrefix) != string::npos)
-            {
-                _source = make_unique<AVLibRTSPSource>(uri);
-            }
-            else
-            {
-                _source = make_unique<AVLibFileSource>(uri);
-            }
+            _source = CreateSource(uri);
             
             // connect to streams
             _source->Connect();
 
             _playing.store(false);
             _looping.store(false);
-
-            // start the main thread
+            _nextReady.store(false);
+            _advanceRequest.store(false);
+            _prepareAlive.store(true);
+            _frameReady.store(false);
+            _recordingPending.store(false);
+            _maxFrameRate.store(0);
+
+            // start the main thread and the playlist preparation thread
             _stayAlive.test_and_set();
             _thread = thread(&AVLibPlayer::MainThreadMethod, this);
+            _prepareThread = thread(&AVLibPlayer::PrepareThreadMethod, this);
         }
 
         AVLibPlayer::~AVLibPlayer()
@@ -42,6 +49,13 @@ namespace UnityAV
             // terminate the running thread first, it accesses both decoders and sources
             _stayAlive.clear();
             _killCondition.notify_all();
+            _frameCondition.notify_all();
+
+            {
+                lock_guard<mutex> lock(_playlistMutex);
+                _prepareAlive.store(false);
+            }
+            _playlistCondition.notify_all();
 
             if (_thread.joinable())
             {
@@ -52,9 +66,26 @@ namespace UnityAV
                 _thread.detach();
             }
 
+            if (_prepareThread.joinable())
+            {
+                _prepareThread.join();
+            }
+            else
+            {
+                _prepareThread.detach();
+            }
+
+            // recordings finish their files before the source they listen to goes
+            auto recorder = DetachRecorder();
+            recorder.reset();
+            auto clipBuffer = DetachClipBuffer();
+            clipBuffer.reset();
+
             // decoders must go next, they access the source
             _decoders.clear();
             _source.reset();
+            _nextDecoders.clear();
+            _nextSource.reset();
         }
 
         void AVLibPlayer::Play()
@@ -62,6 +93,9 @@ namespace UnityAV
             if(!_playing.load())
             {
                 _lastTime = av_gettime_relative();
+
+                lock_guard<mutex> lock(_coreMutex);
+                _source->SetPaused(false);
             }
             
             _playing.store(true);
@@ -69,17 +103,24 @@ namespace UnityAV
 
         void AVLibPlayer::Stop()
         {
+            if (_playing.load())
+            {
+                lock_guard<mutex> lock(_coreMutex);
+                _source->SetPaused(true);
+            }
+
             _playing.store(false);
         }
 
         bool AVLibPlayer::CanSeek() const
         {
+            lock_guard<mutex> lock(_coreMutex);
             return _source->CanSeek();
         }
 
         void AVLibPlayer::Seek(double to)
         {
-            if (!_playing.load() || !_source->CanSeek())
+            if (!_playing.load() || !CanSeek())
             {
                 return;
             }
@@ -95,13 +136,20 @@ namespace UnityAV
                 to = 0;
             }
             
-            _source->Seek(CurrentTime(), to);
+            lock_guard<mutex> lock(_coreMutex);
+
+            // decoders serving from their cache find frames by time alone
+            if (!IsServingFromCache())
+            {
+                _source->Seek(CurrentTime(), to);
+            }
+
             _time = static_cast<int64_t>(to * kSecondToMicrosecond);
         }
 
         bool AVLibPlayer::CanLoop() const
         {
-            return _source->CanSeek();
+            return CanSeek();
         }
 
         void AVLibPlayer::SetLoop(bool loop)
@@ -126,6 +174,7 @@ namespace UnityAV
 
         double AVLibPlayer::Duration() const    
         {
+            lock_guard<mutex> lock(_coreMutex);
             return _source->Duration();
         }
 
@@ -136,9 +185,142 @@ namespace UnityAV
 
         bool AVLibPlayer::IsRealtime() const
         {
+            lock_guard<mutex> lock(_coreMutex);
             return _source->IsRealtime();
         }
 
+        bool AVLibPlayer::Enqueue(const string& uri)
+        {
+            if (!Exists(uri))
+            {
+                return false;
+            }
+
+            {
+                lock_guard<mutex> lock(_playlistMutex);
+                _playlist.push(uri);
+            }
+
+            // wake the preparation thread in case it's idle
+            _playlistCondition.notify_all();
+
+            return true;
+        }
+
+        PlayerStatistics AVLibPlayer::Statistics() const
+        {
+            auto statistics = PlayerStatistics();
+            lock_guard<mutex> lock(_coreMutex);
+
+            _source->CollectStatistics(statistics);
+
+            for (auto i = 0; i < _decoders.size(); ++i)
+            {
+                _decoders[i]->CollectStatistics(statistics);
+            }
+
+            return statistics;
+        }
+
+        bool AVLibPlayer::AddStreamProfile(const string& uri, int width, int height)
+        {
+            lock_guard<mutex> lock(_coreMutex);
+            return _source->AddProfile(uri, VideoDescription(PIXEL_FORMAT_NONE, width, height));
+        }
+
+        void AVLibPlayer::SetDisplaySize(int width, int height)
+        {
+            lock_guard<mutex> lock(_coreMutex);
+            _source->SetDisplaySize(VideoDescription(PIXEL_FORMAT_NONE, width, height));
+        }
+
+        void AVLibPlayer::SetMaxFrameRate(double framesPerSecond)
+        {
+            if (framesPerSecond < 0)
+            {
+                Debug::LogError("AVLibPlayer::SetMaxFrameRate - frame rate must not be negative");
+                return;
+            }
+
+            // decoders created later, for reconnecting or the next media, take it too
+            _maxFrameRate.store(framesPerSecond);
+
+            lock_guard<mutex> lock(_coreMutex);
+            for (auto i = 0; i < _decoders.size(); ++i)
+            {
+                _decoders[i]->SetMaxFrameRate(framesPerSecond);
+            }
+        }
+
+        bool AVLibPlayer::StartRecording(const string& path)
+        {
+            if (path.empty())
+            {
+                Debug::LogError("AVLibPlayer::StartRecording - path was empty");
+                return false;
+            }
+
+            auto previousRecorder = unique_ptr<AVLibRecorder>();
+            auto result = true;
+
+            {
+                lock_guard<mutex> lock(_coreMutex);
+
+                previousRecorder = DetachRecorder();
+                _recordingPath = path;
+
+                // live media is recorded by the main thread once it has connected
+                if (_source->IsConnected())
+                {
+                    result = AttachRecorder();
+                }
+                else
+                {
+                    _recordingPending.store(true);
+                }
+            }
+
+            // finishing the previous file may take a moment, so it's done unlocked
+            previousRecorder.reset();
+
+            return result;
+        }
+
+        void AVLibPlayer::StopRecording()
+        {
+            auto recorder = unique_ptr<AVLibRecorder>();
+
+            {
+                lock_guard<mutex> lock(_coreMutex);
+
+                _recordingPending.store(false);
+                _recordingPath.clear();
+                recorder = DetachRecorder();
+            }
+
+            recorder.reset();
+        }
+
+        bool AVLibPlayer::SaveClip(double secondsBefore, double secondsAfter, const string& path)
+        {
+            if (path.empty())
+            {
+                Debug::LogError("AVLibPlayer::SaveClip - path was empty");
+                return false;
+            }
+
+            lock_guard<mutex> lock(_coreMutex);
+
+            // the clip buffer only exists once the streams are known
+            if (_clipBuffer == nullptr)
+            {
+                Debug::LogError("AVLibPlayer::SaveClip - the media has not connected yet");
+                return false;
+            }
+
+            return _clipBuffer->SaveClip(path, secondsBefore, secondsAfter, *_source);
+        }
+
         void AVLibPlayer::Visit(AVLibVideoDecoder& videoDecoder)
         {
             auto currentTime = CurrentTime();
@@ -152,6 +334,11 @@ namespace UnityAV
                     {
                         Seek(0);
                     }
+                    else if(HasQueued())
+                    {
+                        // the main thread swaps in the next media once it's prepared
+                        _advanceRequest.store(true);
+                    }
                     else
                     {
                         _playing.store(false);
@@ -165,6 +352,11 @@ namespace UnityAV
             }
         }
 
+        unique_ptr<IVideoClient> AVLibPlayer::AdaptClient(unique_ptr<IVideoClient> client) const
+        {
+            return make_unique<AVLibScalingVideoClient>(move(client));
+        }
+
         void AVLibPlayer::ProcessWideInitialize()
         {
             if (!ProcessWideInitialized.test_and_set())
@@ -191,6 +383,22 @@ namespace UnityAV
             return result / 2;
         }
 
+        unique_ptr<IAVLibSource> AVLibPlayer::CreateSource(const string& uri) const
+        {
+            if (uri.find(RTSPPrefix) != string::npos)
+            {
+                // libavformat opens rtsp itself when asked to, like any other media
+                if (_options.Backend == RTSP_BACKEND_AVFORMAT)
+                {
+                    return make_unique<AVLibFileSource>(uri, _options);
+                }
+
+                return make_unique<AVLibRTSPSource>(uri, _options);
+            }
+
+            return make_unique<AVLibFileSource>(uri, _options);
+        }
+
         void AVLibPlayer::MainThreadMethod()
         {
             // ensure we're connected
@@ -200,24 +408,35 @@ namespace UnityAV
             if (stayAlive)
             {
                 // only create the decoders after source is connected
-                _decoders = AVLibDecoder::Create(*_source, RequiredVideoFrame());
-
-                // evaluate the sleeptime if not realtime
-                if (!_source->IsRealtime())
+                auto decoders = CreateDecoders(*_source);
                 {
-                    _sleepTime = SleepTime(_decoders);
-                }
-                else
-                {
-                    // temporary hack for realtime sources
-                    _sleepTime = 50000;
+                    lock_guard<mutex> lock(_coreMutex);
+                    _decoders = move(decoders);
                 }
+                UpdateSleepTime();
+                AttachClipBuffer();
+                StartPendingRecording();
             }
 
             while (stayAlive)
             {
-                // ensure we're still connected
-                stayAlive &= EnsureConnection();
+                // a dropped stream's decoders let go of what they hold before the new
+                // session starts delivering, so none of its packets go with the stale ones
+                if (!_source->IsConnected())
+                {
+                    OnDropout();
+                    stayAlive &= EnsureConnection();
+
+                    if (stayAlive)
+                    {
+                        OnReconnected();
+                    }
+                }
+
+                if (_recordingPending.load() && stayAlive)
+                {
+                    StartPendingRecording();
+                }
 
                 if (_playing.load() && stayAlive)
                 {
@@ -230,10 +449,16 @@ namespace UnityAV
                     {
                         _decoders[i]->Accept(*this);
                     }
+
+                    // swap in the next media when the current has finished
+                    if (_advanceRequest.load() && _nextReady.load())
+                    {
+                        Advance();
+                    }
                 }
 
-                // sleep the thread for a small amount of time
-                this_thread::sleep_for(chrono::microseconds(_sleepTime));
+                // sleep the thread until the next frame is due
+                WaitForNextFrame();
                 stayAlive &= _stayAlive.test_and_set();
             }
         }
@@ -241,19 +466,340 @@ namespace UnityAV
         bool AVLibPlayer::EnsureConnection()
         {
             auto stayAlive = _stayAlive.test_and_set();
+            auto attempt = 0;
 
-            // while the source is not connected, retry
+            // while the source is not connected, retry at once and then back off
             while (!_source->IsConnected() && stayAlive)
             {
                 _source->Connect();
 
-                // wait and use kill condition for early exit
-                auto killLock = unique_lock<mutex>(_killMutex);
-                _killCondition.wait_for(killLock, chrono::milliseconds(ConnectRetryMilliseconds));
-                stayAlive &= _stayAlive.test_and_set();
+                auto deadline = av_gettime_relative() + ReconnectDelay(attempt++);
+
+                // poll for the connection and use kill condition for early exit
+                while (!_source->IsConnected() && stayAlive && av_gettime_relative() < deadline)
+                {
+                    auto killLock = unique_lock<mutex>(_killMutex);
+                    _killCondition.wait_for(killLock, chrono::milliseconds(ConnectPollMilliseconds));
+                    stayAlive &= _stayAlive.test_and_set();
+                }
             }
 
             return stayAlive;
         }
+
+        int64_t AVLibPlayer::ReconnectDelay(int attempt)
+        {
+            // exponential backoff, jittered so many players don't retry in lockstep
+            auto delay = InitialReconnectMicroseconds << min(attempt, 6);
+            delay = min(delay, MaxReconnectMicroseconds);
+
+            return delay / 2 + av_get_random_seed() % (delay / 2 + 1);
+        }
+
+        void AVLibPlayer::OnDropout()
+        {
+            lock_guard<mutex> lock(_coreMutex);
+
+            for (auto i = 0; i < _decoders.size(); ++i)
+            {
+                _decoders[i]->Flush();
+            }
+        }
+
+        void AVLibPlayer::OnReconnected()
+        {
+            auto previousDecoders = vector<unique_ptr<AVLibDecoder>>();
+
+            {
+                lock_guard<mutex> lock(_coreMutex);
+                auto unchanged = !_decoders.empty();
+
+                for (auto i = 0; i < _decoders.size() && unchanged; ++i)
+                {
+                    unchanged = _decoders[i]->CanDecode(*_source);
+                }
+
+                // the decoders and their frames are kept when the stream is the same
+                if (unchanged)
+                {
+                    return;
+                }
+
+                previousDecoders = move(_decoders);
+            }
+
+            Debug::Log("AVLibPlayer::OnReconnected: Stream parameters changed, recreating decoders");
+
+            // the old decoders must stop before the new ones start reading the source
+            previousDecoders.clear();
+
+            auto decoders = CreateDecoders(*_source);
+            {
+                lock_guard<mutex> lock(_coreMutex);
+                _decoders = move(decoders);
+            }
+        }
+
+        bool AVLibPlayer::IsServingFromCache() const
+        {
+            if (_decoders.empty())
+            {
+                return false;
+            }
+
+            for (auto i = 0; i < _decoders.size(); ++i)
+            {
+                if (!_decoders[i]->IsServingFromCache())
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void AVLibPlayer::UpdateSleepTime()
+        {
+            // evaluate the sleeptime if not realtime
+            if (!_source->IsRealtime())
+            {
+                _sleepTime = SleepTime(_decoders);
+            }
+            else
+            {
+                // realtime frames are due whenever the jitter buffer says, so check often
+                _sleepTime = RealtimeSleepMicroseconds;
+            }
+        }
+
+        vector<unique_ptr<AVLibDecoder>> AVLibPlayer::CreateDecoders(IAVLibSource& source)
+        {
+            auto decoders = vector<unique_ptr<AVLibDecoder>>();
+
+            // at low latency live frames are written as soon as they're decoded
+            if (_options.LowLatency && source.IsRealtime())
+            {
+                decoders = AVLibDecoder::Create(source, RequiredVideoFrames(), _options, 
+                    [this] { OnFrameDecoded(); });
+            }
+            else
+            {
+                decoders = AVLibDecoder::Create(source, RequiredVideoFrames(), _options);
+            }
+
+            for (auto i = 0; i < decoders.size(); ++i)
+            {
+                decoders[i]->SetMaxFrameRate(_maxFrameRate.load());
+            }
+
+            return decoders;
+        }
+
+        void AVLibPlayer::WaitForNextFrame()
+        {
+            auto lock = unique_lock<mutex>(_frameMutex);
+
+            // woken early by a decoded frame, otherwise by the regular tick
+            _frameCondition.wait_for(lock, chrono::microseconds(_sleepTime), [this]
+            {
+                return _frameReady.load();
+            });
+
+            _frameReady.store(false);
+        }
+
+        void AVLibPlayer::OnFrameDecoded()
+        {
+            {
+                lock_guard<mutex> lock(_frameMutex);
+                _frameReady.store(true);
+            }
+
+            _frameCondition.notify_one();
+        }
+
+        void AVLibPlayer::PrepareThreadMethod()
+        {
+            while (WaitForPrepareRequest())
+            {
+                string uri;
+                {
+                    lock_guard<mutex> lock(_playlistMutex);
+                    uri = _playlist.front();
+                }
+
+                // open the next source and pre-roll its decoders while the current plays
+                auto source = CreateSource(uri);
+                source->Connect();
+
+                while (!source->IsConnected() && _prepareAlive.load())
+                {
+                    // wait and use playlist condition for early exit
+                    auto lock = unique_lock<mutex>(_playlistMutex);
+                    _playlistCondition.wait_for(lock, chrono::milliseconds(PlaylistConnectRetryMilliseconds));
+                    lock.unlock();
+
+                    if (!source->IsConnected())
+                    {
+                        source->Connect();
+                    }
+                }
+
+                if (!_prepareAlive.load())
+                {
+                    break;
+                }
+
+                // decoders start decoding as soon as they're created
+                auto decoders = CreateDecoders(*source);
+
+                {
+                    lock_guard<mutex> lock(_playlistMutex);
+                    _playlist.pop();
+                    _nextDecoders = move(decoders);
+                    _nextSource = move(source);
+                    _nextReady.store(true);
+                }
+            }
+        }
+
+        bool AVLibPlayer::WaitForPrepareRequest()
+        {
+            auto lock = unique_lock<mutex>(_playlistMutex);
+
+            // only one item is prepared ahead at a time
+            _playlistCondition.wait(lock, [this]
+            {
+                return !_prepareAlive.load() || (!_nextReady.load() && !_playlist.empty());
+            });
+
+            return _prepareAlive.load();
+        }
+
+        bool AVLibPlayer::HasQueued()
+        {
+            lock_guard<mutex> lock(_playlistMutex);
+            return _nextReady.load() || !_playlist.empty();
+        }
+
+        void AVLibPlayer::Advance()
+        {
+            unique_ptr<IAVLibSource> previousSource;
+            vector<unique_ptr<AVLibDecoder>> previousDecoders;
+            unique_ptr<AVLibRecorder> previousRecorder;
+            unique_ptr<AVLibClipBuffer> previousClipBuffer;
+
+            {
+                lock_guard<mutex> coreLock(_coreMutex);
+                lock_guard<mutex> playlistLock(_playlistMutex);
+
+                // a recording covers one media, its streams end with it
+                if (_recorder != nullptr)
+                {
+                    Debug::Log("AVLibPlayer::Advance - finished recording %s",
+                        _recorder->Path().c_str());
+                    previousRecorder = DetachRecorder();
+                }
+                _recordingPending.store(false);
+                _recordingPath.clear();
+                previousClipBuffer = DetachClipBuffer();
+
+                // swap the prepared media in, the time restarts with it
+                previousDecoders = move(_decoders);
+                previousSource = move(_source);
+                _decoders = move(_nextDecoders);
+                _source = move(_nextSource);
+
+                // the next media may have been prepared before the frame rate was capped
+                for (auto i = 0; i < _decoders.size(); ++i)
+                {
+                    _decoders[i]->SetMaxFrameRate(_maxFrameRate.load());
+                }
+                _time = 0;
+                _lastTime = av_gettime_relative();
+
+                _nextReady.store(false);
+                _advanceRequest.store(false);
+            }
+
+            // the next media has its own streams to keep for clips
+            AttachClipBuffer();
+
+            UpdateSleepTime();
+
+            // allow the next item in the playlist to be prepared
+            _playlistCondition.notify_all();
+
+            // decoders and recordings must go before the source they access
+            previousRecorder.reset();
+            previousClipBuffer.reset();
+            previousDecoders.clear();
+            previousSource.reset();
+        }
+
+        void AVLibPlayer::StartPendingRecording()
+        {
+            lock_guard<mutex> lock(_coreMutex);
+
+            if (!_recordingPending.load() || !_source->IsConnected())
+            {
+                return;
+            }
+
+            _recordingPending.store(false);
+            AttachRecorder();
+        }
+
+        bool AVLibPlayer::AttachRecorder()
+        {
+            _recorder = AVLibRecorder::Create(_recordingPath, *_source);
+            if (_recorder == nullptr)
+            {
+                Debug::LogError("AVLibPlayer::AttachRecorder - failed to record to %s",
+                    _recordingPath.c_str());
+                _recordingPath.clear();
+                return false;
+            }
+
+            _source->AddPacketListener(*_recorder);
+
+            return true;
+        }
+
+        void AVLibPlayer::AttachClipBuffer()
+        {
+            lock_guard<mutex> lock(_coreMutex);
+
+            if (_clipBuffer != nullptr || !_source->IsConnected())
+            {
+                return;
+            }
+
+            _clipBuffer = make_unique<AVLibClipBuffer>(*_source, 
+                static_cast<int64_t>(_options.ClipBufferSeconds * kSecondToMicrosecond),
+                static_cast<int64_t>(_options.ClipBufferMegabytes) * kBytesPerMegabyte);
+            _source->AddPacketListener(*_clipBuffer);
+        }
+
+        unique_ptr<AVLibClipBuffer> AVLibPlayer::DetachClipBuffer()
+        {
+            if (_clipBuffer != nullptr)
+            {
+                _source->RemovePacketListener(*_clipBuffer);
+            }
+
+            return move(_clipBuffer);
+        }
+
+        unique_ptr<AVLibRecorder> AVLibPlayer::DetachRecorder()
+        {
+            // the source gives the recorder no packets once it is removed
+            if (_recorder != nullptr)
+            {
+                _source->RemovePacketListener(*_recorder);
+            }
+
+            return move(_recorder);
+        }
     }
 }
@@ -3,6 +3,8 @@
 #include "AVLibUtil.h"
 #include "AVLibDecoder.h"
 #include "AVLibFileSource.h"
+#include "AVLibRecorder.h"
+#include "AVLibClipBuffer.h"
 #include "IAVLibDecoderVisitor.h"
 
 using namespace std;
@@ -21,8 +23,10 @@ namespace UnityAV
             * \brief Initializes a new instance of AVLibPlayer
             * \param uri The uri to load the media from
             * \param client The player client
+            * \param options The options to create the player with
             */
-            explicit AVLibPlayer(const string& uri, unique_ptr<IVideoClient> client);
+            explicit AVLibPlayer(const string& uri, unique_ptr<IVideoClient> client,
+                const PlayerOptions& options = PlayerOptions());
             /**
              * \brief Deconstructs an instance of AVLibPlayer
              */
@@ -39,16 +43,47 @@ namespace UnityAV
             double Duration() const override;
             bool IsPlaying() const override;
             bool IsRealtime() const override;
+            bool Enqueue(const string& uri) override;
+            PlayerStatistics Statistics() const override;
+            bool AddStreamProfile(const string& uri, int width, int height) override;
+            void SetDisplaySize(int width, int height) override;
+            void SetMaxFrameRate(double framesPerSecond) override;
+            bool StartRecording(const string& path) override;
+            void StopRecording() override;
+            bool SaveClip(double secondsBefore, double secondsAfter, const string& path) override;
 
             void Visit(AVLibVideoDecoder& videoDecoder) override;
+
+        protected:
+            unique_ptr<IVideoClient> AdaptClient(unique_ptr<IVideoClient> client) const override;
+
         private:
-            static const int ConnectRetryMilliseconds;
+            static const int PlaylistConnectRetryMilliseconds;
+            static const int64_t RealtimeSleepMicroseconds;
+            static const int64_t InitialReconnectMicroseconds;
+            static const int64_t MaxReconnectMicroseconds;
+            static const int ConnectPollMilliseconds;
+            static const int64_t kBytesPerMegabyte;
 
             static atomic_flag ProcessWideInitialized;
             static void ProcessWideInitialize();
             static int64_t SleepTime(vector<unique_ptr<AVLibDecoder>>& decoders);
 
+            unique_ptr<IAVLibSource> CreateSource(const string& uri) const;
             bool EnsureConnection();
+            static int64_t ReconnectDelay(int attempt);
+            void OnDropout();
+            void OnReconnected();
+            bool IsServingFromCache() const;
+            void UpdateSleepTime();
+            vector<unique_ptr<AVLibDecoder>> CreateDecoders(IAVLibSource& source);
+            void WaitForNextFrame();
+            void OnFrameDecoded();
+            void StartPendingRecording();
+            bool AttachRecorder();
+            unique_ptr<AVLibRecorder> DetachRecorder();
+            void AttachClipBuffer();
+            unique_ptr<AVLibClipBuffer> DetachClipBuffer();
 
             // threading
             void MainThreadMethod();
@@ -56,6 +91,9 @@ namespace UnityAV
             atomic_flag _stayAlive = ATOMIC_FLAG_INIT;
             mutex _killMutex;
             condition_variable _killCondition;
+            mutex _frameMutex;
+            condition_variable _frameCondition;
+            atomic_bool _frameReady;
 
             // playback and timing info
             atomic_bool _playing;
@@ -65,8 +103,32 @@ namespace UnityAV
             int64_t _sleepTime;
 
             // core
+            PlayerOptions _options;
             unique_ptr<IAVLibSource> _source;
             vector<unique_ptr<AVLibDecoder>> _decoders;
+            mutable mutex _coreMutex;
+            atomic<double> _maxFrameRate;
+
+            // playlist
+            void PrepareThreadMethod();
+            bool WaitForPrepareRequest();
+            bool HasQueued();
+            void Advance();
+            thread _prepareThread;
+            mutex _playlistMutex;
+            condition_variable _playlistCondition;
+            queue<string> _playlist;
+            unique_ptr<IAVLibSource> _nextSource;
+            vector<unique_ptr<AVLibDecoder>> _nextDecoders;
+            atomic_bool _nextReady;
+            atomic_bool _advanceRequest;
+            atomic_bool _prepareAlive;
+
+            // recording, the recorder listens to the source and is guarded with it
+            unique_ptr<AVLibRecorder> _recorder;
+            string _recordingPath;
+            atomic_bool _recordingPending;
+            unique_ptr<AVLibClipBuffer> _clipBuffer;
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,155 @@
+﻿#include "stdafx.h"
+#include "AVLibQualityGovernor.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        const int64_t AVLibQualityGovernor::kPeriod = 1000000;
+        const double AVLibQualityGovernor::kOverloadRatio = 0.1;
+        const int AVLibQualityGovernor::kMinRecoveryPeriods = 3;
+        const int AVLibQualityGovernor::kMaxRecoveryPeriods = 48;
+        const int64_t AVLibQualityGovernor::kMinLag = 100000;
+        const int AVLibQualityGovernor::kLagFrames = 3;
+        const int64_t AVLibQualityGovernor::kDiscontinuity = 1000000;
+
+        AVLibQualityGovernor::AVLibQualityGovernor(double frameDuration, int headroomDepth) :
+            _frameDuration(frameDuration), _headroomDepth(headroomDepth), _periodStart(-1),
+            _presentedFrames(0), _lateFrames(0), _minDepth(INT_MAX), _healthyPeriods(0),
+            _recoveryPeriods(kMinRecoveryPeriods), _steppedUp(false), _lagStarted(false),
+            _baseLag(0)
+        {
+            _quality.store(DECODING_QUALITY_FULL);
+            _qualityChanges.store(0);
+        }
+
+        void AVLibQualityGovernor::OnPresented(double lateness, int depth)
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            _presentedFrames++;
+            _minDepth = min(_minDepth, depth);
+
+            // a frame shown more than a frame late while nothing newer has been decoded
+            // means decoding is behind, not just that frames are shown less often
+            if (depth == 0 && _frameDuration > 0 && lateness > _frameDuration)
+            {
+                _lateFrames++;
+            }
+
+            Evaluate();
+        }
+
+        void AVLibQualityGovernor::OnDecoded(double time)
+        {
+            auto now = av_gettime_relative();
+            auto lag = now - static_cast<int64_t>(time * kSecondToMicrosecond);
+
+            lock_guard<mutex> lock(_mutex);
+
+            // the smallest lag seen is when decoding kept up, network jitter aside, the
+            // presentation times jump when rtcp first synchronises them
+            if (!_lagStarted || lag < _baseLag || lag - _baseLag > kDiscontinuity)
+            {
+                _lagStarted = true;
+                _baseLag = lag;
+            }
+
+            // decoding slower than the stream falls further behind with every frame
+            auto allowance = max(kMinLag, static_cast<int64_t>(
+                kLagFrames * _frameDuration * kSecondToMicrosecond));
+            if (lag - _baseLag > allowance)
+            {
+                _lateFrames++;
+            }
+
+            Evaluate();
+        }
+
+        void AVLibQualityGovernor::Reset()
+        {
+            lock_guard<mutex> lock(_mutex);
+
+            _periodStart = -1;
+            _presentedFrames = 0;
+            _lateFrames = 0;
+            _minDepth = INT_MAX;
+            _healthyPeriods = 0;
+            _lagStarted = false;
+        }
+
+        DecodingQuality AVLibQualityGovernor::Quality() const
+        {
+            return static_cast<DecodingQuality>(_quality.load());
+        }
+
+        void AVLibQualityGovernor::CollectStatistics(PlayerStatistics& statistics) const
+        {
+            statistics.QualityLevel = max(statistics.QualityLevel, _quality.load());
+            statistics.QualityChanges += _qualityChanges.load();
+        }
+
+        void AVLibQualityGovernor::Evaluate()
+        {
+            auto now = av_gettime_relative();
+
+            if (_periodStart < 0)
+            {
+                _periodStart = now;
+                return;
+            }
+
+            if (now - _periodStart < kPeriod)
+            {
+                return;
+            }
+
+            auto quality = _quality.load();
+            auto total = _presentedFrames + _lateFrames;
+            auto overloaded = _lateFrames > 0 && _lateFrames >= total * kOverloadRatio;
+            auto headroom = _lateFrames == 0 && _presentedFrames > 0 &&
+                _minDepth >= _headroomDepth;
+
+            if (overloaded)
+            {
+                _healthyPeriods = 0;
+
+                // stepping straight back down means the step up was premature, wait longer
+                if (_steppedUp)
+                {
+                    _recoveryPeriods = min(kMaxRecoveryPeriods, _recoveryPeriods * 2);
+                }
+
+                if (quality < DECODING_QUALITY_HALF_FRAME_RATE)
+                {
+                    _quality.store(quality + 1);
+                    _qualityChanges++;
+                }
+            }
+            else if (headroom && quality > DECODING_QUALITY_FULL &&
+                ++_healthyPeriods >= _recoveryPeriods)
+            {
+                _healthyPeriods = 0;
+                _quality.store(quality - 1);
+                _qualityChanges++;
+            }
+            else if (!headroom)
+            {
+                _healthyPeriods = 0;
+            }
+
+            _steppedUp = !overloaded && _quality.load() < quality;
+
+            // full quality held for a whole period, any earlier overload has passed
+            if (quality == DECODING_QUALITY_FULL && headroom)
+            {
+                _recoveryPeriods = kMinRecoveryPeriods;
+            }
+
+            _periodStart = now;
+            _presentedFrames = 0;
+            _lateFrames = 0;
+            _minDepth = INT_MAX;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "PlayerStatistics.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief The steps decoding degrades through under load, each includes those
+         * before it
+         */
+        enum DecodingQuality
+        {
+            // everything is decoded and scaled at full quality
+            DECODING_QUALITY_FULL = 0,
+            // the deblocking filter is skipped
+            DECODING_QUALITY_SKIP_LOOP_FILTER,
+            // frames which no others refer to are not decoded
+            DECODING_QUALITY_SKIP_NONREF,
+            // frames are scaled with the fast bilinear scaler
+            DECODING_QUALITY_FAST_SCALING,
+            // every other decoded frame is dropped before it is scaled
+            DECODING_QUALITY_HALF_FRAME_RATE,
+        };
+
+        /**
+         * \brief Responsible for trading decoding quality for speed when a player falls
+         * behind, it watches for file frames presented late with nothing newer decoded and
+         * for live frames decoded ever later after they arrived, steps down while
+         * overloaded and back up once there has been headroom for a while, frames dropped
+         * because they're presented less often than decoded aren't overload
+         */
+        class AVLibQualityGovernor
+        {
+        public:
+            // Default destructor
+            virtual ~AVLibQualityGovernor(){}
+            /**
+             * \brief Initializes a new instance of AVLibQualityGovernor
+             * \param frameDuration The duration of a frame in seconds, frames presented
+             * later than this with nothing newer waiting count as late
+             * \param headroomDepth The number of frames which must be waiting throughout
+             * a period for it to count as having headroom
+             */
+            explicit AVLibQualityGovernor(double frameDuration, int headroomDepth);
+            // Disabled copy constructor
+            explicit AVLibQualityGovernor(const AVLibQualityGovernor&& other) = delete;
+            // Disabled copy assignment
+            AVLibQualityGovernor& operator=(const AVLibQualityGovernor&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibQualityGovernor(AVLibQualityGovernor&& other) = delete;
+            // Disabled move assignment
+            AVLibQualityGovernor& operator=(AVLibQualityGovernor&& other) = delete;
+
+            /**
+             * \brief Records the presentation of a frame
+             * \param lateness How far behind its time the frame was presented in seconds
+             * \param depth The number of frames waiting behind it
+             */
+            void OnPresented(double lateness, int depth);
+            /**
+             * \brief Records a live frame leaving the decoder, called as frames are decoded
+             * \param time The presentation time of the frame in seconds
+             */
+            void OnDecoded(double time);
+            /**
+             * \brief Forgets the current period, for when playback jumps, the quality
+             * is kept
+             */
+            void Reset();
+            /**
+             * \brief Evaluates the quality decoding should run at, safe to call from
+             * any thread
+             * \return The decoding quality
+             */
+            DecodingQuality Quality() const;
+            /**
+             * \brief Adds the governor's statistics to the given statistics
+             * \param statistics The statistics to add to
+             */
+            void CollectStatistics(PlayerStatistics& statistics) const;
+
+        private:
+            static const int64_t kPeriod;
+            static const double kOverloadRatio;
+            static const int kMinRecoveryPeriods;
+            static const int kMaxRecoveryPeriods;
+            static const int64_t kMinLag;
+            static const int kLagFrames;
+            static const int64_t kDiscontinuity;
+
+            void Evaluate();
+
+            // core
+            double _frameDuration;
+            int _headroomDepth;
+            int64_t _periodStart;
+            int _presentedFrames;
+            int _lateFrames;
+            int _minDepth;
+            int _healthyPeriods;
+            int _recoveryPeriods;
+            bool _steppedUp;
+            bool _lagStarted;
+            int64_t _baseLag;
+            mutable mutex _mutex;
+
+            // meta
+            atomic_int _quality;
+            atomic<int64_t> _qualityChanges;
+        };
+    }
+}
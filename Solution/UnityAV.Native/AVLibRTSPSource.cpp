@@ -7,50 +7,67 @@ namespace UnityAV
     {
         const AVStream AVLibRTSPSource::EmptyStream = AVStream();
         const int AVLibRTSPSource::DefaultPacketQueueSize = 10;
-
-        mutex AVLibRTSPSource::ProcessWideMutex;
-        atomic_flag AVLibRTSPSource::ProcessWideInitialized = ATOMIC_FLAG_INIT;
-        int AVLibRTSPSource::InstanceCount = 0;
-        thread AVLibRTSPSource::TaskSchedulerThread;
-        volatile char AVLibRTSPSource::WatchVariable = 0;
-        unique_ptr<BasicTaskScheduler> AVLibRTSPSource::TaskScheduler;
-        unique_ptr<BasicUsageEnvironment, BasicUsageEnvrionmentDeleter> AVLibRTSPSource::Environment;
+        const int64_t AVLibRTSPSource::KeyframeRequestIntervalMicroseconds = 1000000;
+        const int64_t AVLibRTSPSource::ProfileSwitchTimeoutMicroseconds = 5000000;
+        const int64_t AVLibRTSPSource::LiveEdgeMicroseconds = 1000000;
+        const int64_t AVLibRTSPSource::kBytesPerMegabyte = 1024 * 1024;
 
         AVLibRTSPSource::~AVLibRTSPSource()
         {
-            // destroy client before process wide teardown
-            _rtspClient.reset();
+            // stop clients passing on live packets before anything is torn down
+            _liveClient.store(nullptr);
+            if (_rtspClient != nullptr)
+            {
+                _rtspClient->SetPacketCallback(nullptr);
+            }
+            if (_pendingClient != nullptr)
+            {
+                _pendingClient->SetPacketCallback(nullptr);
+            }
 
-            // teardown live555 across the process
-            ProcessWideTeardown();
+            // destroy clients before their scheduler may be torn down
+            _switchPacket.reset();
+            _pendingClient.reset();
+            _rtspClient.reset();
+            _scheduler.reset();
         }
 
-        AVLibRTSPSource::AVLibRTSPSource(const string& uri) : _recycler(DefaultPacketQueueSize),
-            _uri(uri)
+        AVLibRTSPSource::AVLibRTSPSource(const string& uri, const PlayerOptions& options) 
+            : _scheduler(Live555Scheduler::Acquire()), _activeProfile(0), _pendingProfile(-1),
+            _pendingStartTime(0), _pendingKeyframeRequested(false), _switchStreamIndex(-1),
+            _recycler(DefaultPacketQueueSize), _options(options), _timeShifted(false),
+            _paused(false), _shiftAnchorTime(0), _shiftAnchorPosition(0), _shiftPosition(0),
+            _requestKeyframes(options.RequestKeyframes), _lastKeyframeRequest(0)
         {
-            // initialize live555 across the process
-            ProcessWideInitialize();
-
-            // fill in the fake codec parameters
-            auto codecParameters = new AVCodecParameters();
-            codecParameters->width = 1280;
-            codecParameters->height = 800;
-            codecParameters->format = AV_PIX_FMT_YUV420P;
-            codecParameters->codec_type = AVMEDIA_TYPE_VIDEO;
-            codecParameters->codec_id = AV_CODEC_ID_MJPEG;
+            // the main profile's size is only known once connected
+            _profiles.push_back({ uri, VideoDescription() });
+            _requestedProfile.store(0);
 
-            // create the fake stream
-            auto stream = AVStream();
-            stream.index = 0;
-            stream.nb_frames = 0;
-            stream.codecpar = codecParameters;
+            // live packets are kept in a ring when the feed may be paused and rewound
+            if (options.TimeShiftSeconds > 0)
+            {
+                _ring = make_unique<AVLibPacketRing>(
+                    static_cast<int64_t>(options.TimeShiftSeconds * kSecondToMicrosecond),
+                    static_cast<int64_t>(options.TimeShiftMegabytes) * kBytesPerMegabyte,
+                    static_cast<int64_t>(options.TimeShiftSpillMegabytes) * kBytesPerMegabyte);
+            }
+            _liveClient.store(nullptr);
+            _listenerDiscontinuity.store(false);
+            _ringDiscontinuity.store(false);
 
-            _streams.push_back(stream);
-            _streamTypes.push_back(AVMEDIA_TYPE_VIDEO);
+            _framesAwaitingKeyframe.store(0);
+            _keyframeRequests.store(0);
         }
 
         double AVLibRTSPSource::Duration() const
         {
+            // the time shift window is the seekable duration
+            if (_ring != nullptr)
+            {
+                auto oldest = _ring->OldestTime();
+                return oldest < 0 ? 0 : (_ring->NewestTime() - oldest) * kMicrosecondToSecond;
+            }
+
             Debug::LogWarning("AVLibRTSPSource::Duration - AVLibRTSPSource is realtime and duration cannot be determined");
             // is realtime, no duration known
             return -1;
@@ -58,23 +75,34 @@ namespace UnityAV
 
         void AVLibRTSPSource::Connect()
         {
+            lock_guard<mutex> lock(_clientMutex);
+
             if(_rtspClient == nullptr)
             {
                 // create and connect our rtsp client
-                _rtspClient = unique_ptr<Live555RTSPClient,
-                    Live555RTSPClient::Live555RTSPClientDeleter>(new Live555RTSPClient(
-                        *Environment, _uri));
+                _rtspClient = CreateClient(_activeProfile);
             }
             else if (_rtspClient->ConnectionDropped())
             {
-                // reset client when connection has failed or been dropped
-                _rtspClient = unique_ptr<Live555RTSPClient,
-                    Live555RTSPClient::Live555RTSPClientDeleter>(new Live555RTSPClient(
-                        *Environment, _uri));
+                // reset client when connection has failed or been dropped, along with
+                // any profile switch that was under way
+                AbandonProfileSwitch();
+                _rtspClient = CreateClient(_activeProfile);
             }
 
             if (_rtspClient != nullptr)
             {
+                // a new session must be joined at a keyframe
+                {
+                    lock_guard<mutex> gateLock(_gateMutex);
+                    _awaitingKeyframe.clear();
+                }
+
+                // listeners and the ring mark where the new session begins
+                _liveClient.store(_rtspClient.get());
+                _listenerDiscontinuity.store(true);
+                _ringDiscontinuity.store(true);
+
                 _rtspClient->Connect();
             }
             else
@@ -85,6 +113,8 @@ namespace UnityAV
 
         bool AVLibRTSPSource::IsConnected() const
         {
+            lock_guard<mutex> lock(_clientMutex);
+
             if (_rtspClient == nullptr)
             {
                 return false;
@@ -95,14 +125,21 @@ namespace UnityAV
 
         int AVLibRTSPSource::StreamCount() const
         {
-            return static_cast<int>(_streams.size());
+            lock_guard<mutex> lock(_clientMutex);
+
+            // the streams are only known once the sdp has been received
+            if (_rtspClient == nullptr || !_rtspClient->IsConnected())
+            {
+                return 0;
+            }
+
+            return _rtspClient->SubsessionCount();
         }
 
         double AVLibRTSPSource::TimeBase(int streamIndex) const
         {
-            Debug::LogWarning("AVLibRTSPSource::TimeBase - AVLibRTSPSource is realtime and timebase cannot be determined");
-            // is realtime, no pts used
-            return -1;
+            // is realtime, pts are presentation times in microseconds
+            return kMicrosecondToSecond;
         }
 
         double AVLibRTSPSource::FrameRate(int streamIndex) const
@@ -121,34 +158,38 @@ namespace UnityAV
 
         AVMediaType AVLibRTSPSource::StreamType(int streamIndex) const
         {
-            if(streamIndex >= _streamTypes.size())
+            lock_guard<mutex> lock(_clientMutex);
+
+            if(_rtspClient == nullptr || !_rtspClient->IsConnected())
             {
-                Debug::LogError("AVLibRTSPSource::StreamType - streamIndex was out of range");
                 return AVMEDIA_TYPE_UNKNOWN;
             }
 
-            if(!IsConnected())
+            if(streamIndex >= _rtspClient->SubsessionCount())
             {
+                Debug::LogError("AVLibRTSPSource::StreamType - streamIndex was out of range");
                 return AVMEDIA_TYPE_UNKNOWN;
             }
 
-            return _streamTypes[streamIndex];
+            return _rtspClient->SubsessionStream(streamIndex).codecpar->codec_type;
         }
 
         const AVStream& AVLibRTSPSource::Stream(int streamIndex) const
         {
-            if (streamIndex >= _streamTypes.size())
+            lock_guard<mutex> lock(_clientMutex);
+
+            if(_rtspClient == nullptr || !_rtspClient->IsConnected())
             {
-                Debug::LogError("AVLibRTSPSource::Stream - streamIndex was out of range");
                 return EmptyStream;
             }
 
-            if(!IsConnected())
+            if (streamIndex >= _rtspClient->SubsessionCount())
             {
+                Debug::LogError("AVLibRTSPSource::Stream - streamIndex was out of range");
                 return EmptyStream;
             }
 
-            return _streams[streamIndex];
+            return _rtspClient->SubsessionStream(streamIndex);
         }
 
         bool AVLibRTSPSource::IsRealtime() const
@@ -158,38 +199,139 @@ namespace UnityAV
 
         bool AVLibRTSPSource::CanSeek() const
         {
-            return false;
+            // only the time shift window can be sought within
+            return _ring != nullptr;
         }
 
         void AVLibRTSPSource::Seek(double from, double to)
         {
-            Debug::LogWarning("AVLibRTSPSource::Seek - AVLibRTSPSource is realtime and cannot seek");
-            // do nothing, can't seek
+            if (_ring == nullptr)
+            {
+                Debug::LogWarning("AVLibRTSPSource::Seek - AVLibRTSPSource is realtime and cannot seek");
+                // do nothing, can't seek
+                return;
+            }
+
+            lock_guard<mutex> lock(_clientMutex);
+
+            auto oldest = _ring->OldestTime();
+            auto newest = _ring->NewestTime();
+            if (oldest < 0)
+            {
+                return;
+            }
+
+            // times are relative to the oldest packet held, the live edge rejoins live
+            auto target = oldest + static_cast<int64_t>(to * kSecondToMicrosecond);
+            auto live = target >= newest - LiveEdgeMicroseconds;
+            auto keyframe = _ring->FindKeyframe(live ? newest : target);
+
+            if (keyframe < 0)
+            {
+                Debug::LogWarning("AVLibRTSPSource::Seek - no keyframe has been received to seek to");
+                return;
+            }
+
+            ResetShiftState();
+            for (auto i = 0; i < _shiftCursors.size(); ++i)
+            {
+                _shiftCursors[i] = keyframe;
+                _shiftSeekPending[i] = true;
+            }
+
+            _timeShifted = !live;
+            _shiftPosition = _ring->TimeOf(keyframe);
+            _shiftAnchorPosition = _shiftPosition;
+            _shiftAnchorTime = av_gettime_relative();
+        }
+
+        void AVLibRTSPSource::AddPacketListener(IAVLibPacketListener& listener)
+        {
+            lock_guard<mutex> lock(_listenersMutex);
+
+            if (find(_packetListeners.begin(), _packetListeners.end(), &listener) == 
+                _packetListeners.end())
+            {
+                _packetListeners.push_back(&listener);
+            }
+        }
+
+        void AVLibRTSPSource::RemovePacketListener(IAVLibPacketListener& listener)
+        {
+            lock_guard<mutex> lock(_listenersMutex);
+
+            _packetListeners.erase(remove(_packetListeners.begin(), _packetListeners.end(), 
+                &listener), _packetListeners.end());
+        }
+
+        void AVLibRTSPSource::SetPaused(bool paused)
+        {
+            // without a ring, live streams carry on regardless
+            if (_ring == nullptr)
+            {
+                return;
+            }
+
+            lock_guard<mutex> lock(_clientMutex);
+
+            if (paused == _paused)
+            {
+                return;
+            }
+
+            _paused = paused;
+
+            // pausing falls behind the live edge, resuming plays on from where it was
+            if (paused)
+            {
+                _timeShifted = true;
+            }
+            else
+            {
+                _shiftAnchorPosition = _shiftPosition;
+                _shiftAnchorTime = av_gettime_relative();
+            }
         }
 
         unique_ptr<AVLibPacket> AVLibRTSPSource::TryGetNext(int streamIndex)
         {
-            if (streamIndex >= _streamTypes.size())
+            lock_guard<mutex> lock(_clientMutex);
+
+            if(_rtspClient == nullptr || !_rtspClient->IsConnected())
             {
-                Debug::LogError("AVLibRTSPSource::TryGetNext - streamIndex was out of range");
                 return nullptr;
             }
 
-            if(!IsConnected())
+            if (streamIndex >= _rtspClient->SubsessionCount())
             {
+                Debug::LogError("AVLibRTSPSource::TryGetNext - streamIndex was out of range");
                 return nullptr;
             }
 
-            auto live555Packet = _rtspClient->TryGetNext(streamIndex);
+            UpdateProfileSwitch();
 
-            if (live555Packet != nullptr)
+            if (_ring != nullptr)
             {
-                auto avlibPacket = _recycler.GetPacket();
+                return TryGetFromRing(streamIndex);
+            }
+
+            // a switched profile starts from the keyframe that completed the switch
+            auto switched = _switchPacket != nullptr && _switchStreamIndex == streamIndex;
+            auto live555Packet = switched ? move(_switchPacket) : 
+                _rtspClient->TryGetNext(streamIndex);
 
-                // point the packets data to the live555's packets data
-                avlibPacket->Packet().data = live555Packet->Data();
-                avlibPacket->Packet().size = live555Packet->DataSize();
+            // anything ahead of the keyframe can't be decoded cleanly
+            while (live555Packet != nullptr && AwaitsKeyframe(streamIndex, 
+                live555Packet->IsDiscontinuity(), live555Packet->Data(), live555Packet->DataSize()))
+            {
+                _rtspClient->Recycle(move(live555Packet), streamIndex);
+                live555Packet = _rtspClient->TryGetNext(streamIndex);
+                switched = false;
+            }
 
+            if (live555Packet != nullptr)
+            {
+                auto avlibPacket = ToAVLibPacket(*live555Packet, streamIndex, switched);
                 _rtspClient->Recycle(move(live555Packet), streamIndex);
 
                 return avlibPacket;
@@ -209,46 +351,575 @@ namespace UnityAV
             _recycler.Recycle(move(packet));
         }
 
-        void AVLibRTSPSource::ProcessWideInitialize()
+        void AVLibRTSPSource::CollectStatistics(PlayerStatistics& statistics) const
         {
-            auto lock = unique_lock<mutex>(ProcessWideMutex);
+            {
+                lock_guard<mutex> lock(_clientMutex);
+
+                if (_rtspClient != nullptr)
+                {
+                    _rtspClient->CollectStatistics(statistics);
+                }
+            }
+
+            statistics.FramesAwaitingKeyframe += _framesAwaitingKeyframe.load();
+            statistics.KeyframeRequests += _keyframeRequests.load();
+        }
+
+        bool AVLibRTSPSource::AddProfile(const string& uri, const IVideoDescription& description)
+        {
+            if (description.Width() <= 0 || description.Height() <= 0)
+            {
+                Debug::LogError("AVLibRTSPSource::AddProfile - profile size must be positive");
+                return false;
+            }
+
+            lock_guard<mutex> lock(_profileMutex);
+
+            // the main uri may be given to describe the main profile's size
+            auto known = false;
+            for (auto i = 0; i < _profiles.size(); ++i)
+            {
+                if (_profiles[i].Uri == uri)
+                {
+                    _profiles[i].Video = VideoDescription(description);
+                    known = true;
+                }
+            }
+
+            if (!known)
+            {
+                _profiles.push_back({ uri, VideoDescription(description) });
+            }
+
+            if (_displaySize.Width() > 0 && _displaySize.Height() > 0)
+            {
+                _requestedProfile.store(SelectProfile());
+            }
+
+            return true;
+        }
+
+        void AVLibRTSPSource::SetDisplaySize(const IVideoDescription& description)
+        {
+            lock_guard<mutex> lock(_profileMutex);
+
+            _displaySize = VideoDescription(description);
+            _requestedProfile.store(SelectProfile());
+        }
+
+        bool AVLibRTSPSource::AwaitsKeyframe(int streamIndex, bool discontinuity, 
+            const uint8_t* data, int size)
+        {
+            lock_guard<mutex> lock(_gateMutex);
+
+            // every stream of a newly joined session waits for a keyframe
+            auto streamCount = _rtspClient->SubsessionCount();
+            if (_awaitingKeyframe.size() != streamCount)
+            {
+                _awaitingKeyframe.assign(streamCount, true);
+            }
 
-            if (++InstanceCount <= 1)
+            // after losing data the stream waits again
+            if (discontinuity)
             {
-                // the task scheduler should not exit the eventloop, zero does the job
-                WatchVariable = 0;
+                _awaitingKeyframe[streamIndex] = true;
+            }
+
+            if (!_awaitingKeyframe[streamIndex])
+            {
+                return false;
+            }
 
-                TaskScheduler = unique_ptr<BasicTaskScheduler>(BasicTaskScheduler::createNew());
-                Environment = unique_ptr<BasicUsageEnvironment,
-                    BasicUsageEnvrionmentDeleter>(BasicUsageEnvironment::createNew(*TaskScheduler));
-                TaskSchedulerThread = thread(SchedulerThreadMethod);
+            auto codecId = _rtspClient->SubsessionStream(streamIndex).codecpar->codec_id;
+            if (IsKeyframe(codecId, data, size))
+            {
+                _awaitingKeyframe[streamIndex] = false;
+                return false;
+            }
+
+            _framesAwaitingKeyframe++;
+
+            // ask for a keyframe rather than waiting out the group of pictures
+            auto now = av_gettime_relative();
+            if (_requestKeyframes && !_timeShifted &&
+                now - _lastKeyframeRequest > KeyframeRequestIntervalMicroseconds)
+            {
+                _lastKeyframeRequest = now;
+                _keyframeRequests++;
+                _rtspClient->RequestKeyframe();
             }
+
+            return true;
         }
 
-        void AVLibRTSPSource::ProcessWideTeardown()
+        AVLibRTSPSource::ClientPtr AVLibRTSPSource::CreateClient(int profile)
         {
-            auto lock = unique_lock<mutex>(ProcessWideMutex);
+            auto uri = string();
+            {
+                lock_guard<mutex> lock(_profileMutex);
+                uri = _profiles[profile].Uri;
+            }
+
+            auto client = ClientPtr(new Live555RTSPClient(*_scheduler, uri, 
+                _options));
 
-            if (--InstanceCount <= 0)
+            // only the active client's packets are passed on, see _liveClient
+            auto rawClient = client.get();
+            client->SetPacketCallback([this, rawClient](int streamIndex, Live555Packet& packet)
             {
-                // notify the task scheduler to exit the eventloop, nonzero does the job
-                WatchVariable = -1;
+                if (rawClient != _liveClient.load())
+                {
+                    return false;
+                }
 
-                // enter the event loop thread to ensure it exits before moving on
-                if (TaskSchedulerThread.joinable())
+                // the ring takes every live packet here, so those queued before the client
+                // went live, such as after a profile switch, go ahead of anything newer
+                if (_ring != nullptr)
                 {
-                    TaskSchedulerThread.join();
+                    DrainQueuedPackets(*rawClient);
                 }
 
-                Environment.reset();
-                TaskScheduler.reset();
+                OnLivePacket(*rawClient, streamIndex, packet);
+
+                return _ring != nullptr;
+            });
+
+            return client;
+        }
+
+        int AVLibRTSPSource::SelectProfile() const
+        {
+            // profiles of unknown size are taken to be the largest
+            auto area = [](const IVideoDescription& video)
+            {
+                return video.Width() > 0 && video.Height() > 0 ? 
+                    static_cast<int64_t>(video.Width()) * video.Height() : INT64_MAX;
+            };
+
+            auto covering = -1;
+            auto largest = 0;
+
+            for (auto i = 0; i < _profiles.size(); ++i)
+            {
+                auto& video = _profiles[i].Video;
+
+                if (area(video) > area(_profiles[largest].Video))
+                {
+                    largest = i;
+                }
+
+                auto covers = area(video) == INT64_MAX || (video.Width() >= _displaySize.Width() &&
+                    video.Height() >= _displaySize.Height());
+
+                if (covers && (covering < 0 || area(video) < area(_profiles[covering].Video)))
+                {
+                    covering = i;
+                }
             }
+
+            // the smallest profile that covers the display, otherwise the sharpest one
+            return covering >= 0 ? covering : largest;
         }
 
-        void AVLibRTSPSource::SchedulerThreadMethod()
+        void AVLibRTSPSource::UpdateProfileSwitch()
         {
-            // enter the event loop
-            Environment->taskScheduler().doEventLoop(&WatchVariable);
+            auto requested = _requestedProfile.load();
+
+            // the display changed again before the pending profile was ready
+            if (_pendingClient != nullptr && requested != _pendingProfile)
+            {
+                AbandonProfileSwitch();
+            }
+
+            if (_pendingClient == nullptr)
+            {
+                if (requested != _activeProfile)
+                {
+                    // the active client keeps serving while the new profile connects
+                    _pendingClient = CreateClient(requested);
+                    _pendingProfile = requested;
+                    _pendingStartTime = av_gettime_relative();
+                    _pendingKeyframeRequested = false;
+                    _pendingClient->Connect();
+                }
+
+                return;
+            }
+
+            if (_pendingClient->ConnectionDropped())
+            {
+                Debug::LogWarning("AVLibRTSPSource::UpdateProfileSwitch - failed to connect to "
+                    "the requested profile");
+                AbandonProfileSwitch();
+                return;
+            }
+
+            if (av_gettime_relative() - _pendingStartTime > ProfileSwitchTimeoutMicroseconds)
+            {
+                Debug::LogWarning("AVLibRTSPSource::UpdateProfileSwitch - the requested profile "
+                    "did not reach a keyframe in time");
+                AbandonProfileSwitch();
+                return;
+            }
+
+            if (!_pendingClient->IsConnected())
+            {
+                return;
+            }
+
+            // decoders are kept across the switch, so the streams must match
+            if (!IsCompatible(*_rtspClient, *_pendingClient))
+            {
+                Debug::LogWarning("AVLibRTSPSource::UpdateProfileSwitch - the requested profile "
+                    "has different streams to the active profile");
+                AbandonProfileSwitch();
+                return;
+            }
+
+            if (_requestKeyframes && !_pendingKeyframeRequested)
+            {
+                _pendingKeyframeRequested = true;
+                _keyframeRequests++;
+                _pendingClient->RequestKeyframe();
+            }
+
+            // the switch happens on the first video keyframe, until then the pending
+            // profile's video is discarded
+            for (auto i = 0; i < _pendingClient->SubsessionCount(); ++i)
+            {
+                auto codecpar = _pendingClient->SubsessionStream(i).codecpar;
+                if (codecpar->codec_type != AVMEDIA_TYPE_VIDEO)
+                {
+                    continue;
+                }
+
+                auto packet = _pendingClient->TryGetNext(i);
+                while (packet != nullptr)
+                {
+                    if (IsKeyframe(codecpar->codec_id, packet->Data(), packet->DataSize()))
+                    {
+                        _switchPacket = move(packet);
+                        _switchStreamIndex = i;
+                        SwitchProfile();
+                        return;
+                    }
+
+                    _pendingClient->Recycle(move(packet), i);
+                    packet = _pendingClient->TryGetNext(i);
+                }
+
+                break;
+            }
+        }
+
+        void AVLibRTSPSource::SwitchProfile()
+        {
+            // the replaced client is shut down, its packets are never decoded
+            _rtspClient->SetPacketCallback(nullptr);
+            _rtspClient = move(_pendingClient);
+            _activeProfile = _pendingProfile;
+            _pendingProfile = -1;
+
+            // listeners resume from the new profile's next keyframe, unless the packets
+            // from the switching keyframe on are drained into the ring
+            _listenerDiscontinuity.store(true);
+
+            // the ring continues from the switching keyframe, whatever followed it is
+            // drained into the ring by the client's next live packet
+            if (_ring != nullptr)
+            {
+                OnLivePacket(*_rtspClient, _switchStreamIndex, *_switchPacket);
+                _rtspClient->Recycle(move(_switchPacket), _switchStreamIndex);
+            }
+
+            _liveClient.store(_rtspClient.get());
+
+            {
+                lock_guard<mutex> lock(_gateMutex);
+                _awaitingKeyframe.clear();
+            }
+
+            Debug::Log("AVLibRTSPSource::SwitchProfile - switched to profile %d", _activeProfile);
+        }
+
+        void AVLibRTSPSource::AbandonProfileSwitch()
+        {
+            _switchPacket.reset();
+            _pendingClient.reset();
+
+            // stay on the active profile unless another has been requested meanwhile
+            auto pending = _pendingProfile;
+            _requestedProfile.compare_exchange_strong(pending, _activeProfile);
+            _pendingProfile = -1;
+        }
+
+        unique_ptr<AVLibPacket> AVLibRTSPSource::TryGetFromRing(int streamIndex)
+        {
+            // the live client's packets go straight to the ring, its queues stay empty,
+            // so it's checked for dropping out here instead
+            _rtspClient->CheckConnection();
+
+            if (_shiftCursors.size() != _rtspClient->SubsessionCount())
+            {
+                ResetShiftState();
+            }
+
+            // decoders drop what they hold before playing from a new position
+            if (_shiftSeekPending[streamIndex])
+            {
+                _shiftSeekPending[streamIndex] = false;
+
+                auto seekPacket = _recycler.GetPacket();
+                seekPacket->SetSeekRequest((_shiftPosition - _ring->OldestTime()) * 
+                    kMicrosecondToSecond);
+                return seekPacket;
+            }
+
+            if (_paused)
+            {
+                return nullptr;
+            }
+
+            auto& next = _shiftNext[streamIndex];
+            while (next == nullptr)
+            {
+                next = _recycler.GetPacket();
+                auto& cursor = _shiftCursors[streamIndex];
+                auto discontinuity = false;
+
+                if (!_ring->TryGet(streamIndex, cursor, next->Packet(), discontinuity))
+                {
+                    _recycler.Recycle(move(next));
+
+                    // having caught up, playback is live again
+                    if (_timeShifted)
+                    {
+                        Debug::Log("AVLibRTSPSource::TryGetFromRing - caught up with the live edge");
+                        _timeShifted = false;
+                    }
+
+                    return nullptr;
+                }
+
+                cursor++;
+
+                // anything ahead of the keyframe can't be decoded cleanly
+                auto& packet = next->Packet();
+                if (AwaitsKeyframe(streamIndex, discontinuity, packet.data, packet.size))
+                {
+                    _recycler.Recycle(move(next));
+                    continue;
+                }
+
+                // a live reader which falls behind skips to the newest keyframe
+                auto newest = _ring->NewestTime();
+                if (!_timeShifted && newest - packet.pts > LiveEdgeMicroseconds)
+                {
+                    auto keyframe = _ring->FindKeyframe(newest);
+                    if (keyframe > cursor)
+                    {
+                        cursor = keyframe;
+                        _recycler.Recycle(move(next));
+                        continue;
+                    }
+                }
+            }
+
+            // time shifted packets are paced by their presentation times
+            if (_timeShifted)
+            {
+                auto elapsed = av_gettime_relative() - _shiftAnchorTime;
+                auto due = _shiftAnchorPosition + static_cast<int64_t>(elapsed * 
+                    _options.CatchUpSpeed);
+
+                if (next->Packet().pts > due)
+                {
+                    return nullptr;
+                }
+            }
+
+            _shiftPosition = max(_shiftPosition, next->Packet().pts);
+            next->Packet().stream_index = streamIndex;
+
+            return move(next);
+        }
+
+        void AVLibRTSPSource::ResetShiftState()
+        {
+            for (auto i = 0; i < _shiftNext.size(); ++i)
+            {
+                if (_shiftNext[i] != nullptr)
+                {
+                    _recycler.Recycle(move(_shiftNext[i]));
+                }
+            }
+
+            auto streamCount = _rtspClient != nullptr ? _rtspClient->SubsessionCount() : 0;
+            _shiftCursors.assign(streamCount, 0);
+            _shiftSeekPending.assign(streamCount, false);
+            _shiftNext.clear();
+            _shiftNext.resize(streamCount);
+        }
+
+        void AVLibRTSPSource::OnLivePacket(Live555RTSPClient& client, int streamIndex, 
+            Live555Packet& live555Packet)
+        {
+            if (_ring != nullptr)
+            {
+                FeedRing(client, streamIndex, live555Packet);
+            }
+
+            NotifyListeners(client, streamIndex, live555Packet);
+        }
+
+        void AVLibRTSPSource::DrainQueuedPackets(Live555RTSPClient& client)
+        {
+            for (auto i = 0; i < client.SubsessionCount(); ++i)
+            {
+                auto packet = client.TryGetNext(i);
+                while (packet != nullptr)
+                {
+                    OnLivePacket(client, i, *packet);
+                    client.Recycle(move(packet), i);
+                    packet = client.TryGetNext(i);
+                }
+            }
+        }
+
+        void AVLibRTSPSource::FeedRing(Live555RTSPClient& client, int streamIndex, 
+            Live555Packet& live555Packet)
+        {
+            auto parameters = client.SubsessionStream(streamIndex).codecpar;
+            auto keyframe = parameters->codec_type == AVMEDIA_TYPE_VIDEO &&
+                IsKeyframe(parameters->codec_id, live555Packet.Data(), live555Packet.DataSize());
+
+            // every keyframe carries the parameter sets, so playback may start at any
+            auto prefixSize = keyframe ? parameters->extradata_size : 0;
+
+            // the data is copied, the received buffer is sized for the largest frame
+            auto packet = CreatePacket(prefixSize + live555Packet.DataSize());
+            if (packet == nullptr)
+            {
+                Debug::LogError("AVLibRTSPSource::FeedRing - failed to allocate packet");
+                return;
+            }
+
+            if (prefixSize > 0)
+            {
+                memcpy(packet->data, parameters->extradata, prefixSize);
+            }
+            memcpy(packet->data + prefixSize, live555Packet.Data(), live555Packet.DataSize());
+
+            packet->pts = live555Packet.PresentationTime();
+            packet->stream_index = streamIndex;
+            packet->flags = keyframe ? AV_PKT_FLAG_KEY : 0;
+
+            auto discontinuity = live555Packet.IsDiscontinuity();
+            discontinuity |= _ringDiscontinuity.exchange(false);
+
+            _ring->Push(move(packet), discontinuity);
+        }
+
+        void AVLibRTSPSource::NotifyListeners(Live555RTSPClient& client, int streamIndex, 
+            Live555Packet& live555Packet)
+        {
+            lock_guard<mutex> lock(_listenersMutex);
+
+            if (_packetListeners.empty())
+            {
+                return;
+            }
+
+            auto parameters = client.SubsessionStream(streamIndex).codecpar;
+            auto keyframe = parameters->codec_type == AVMEDIA_TYPE_VIDEO &&
+                IsKeyframe(parameters->codec_id, live555Packet.Data(), live555Packet.DataSize());
+
+            // the packet borrows the received buffer, listeners reference it to keep it
+            auto packet = AVPacket();
+            av_init_packet(&packet);
+            packet.buf = live555Packet.Buffer();
+            packet.data = live555Packet.Data();
+            packet.size = live555Packet.DataSize();
+            packet.pts = live555Packet.PresentationTime();
+            packet.stream_index = streamIndex;
+            packet.flags = keyframe ? AV_PKT_FLAG_KEY : 0;
+
+            auto discontinuity = live555Packet.IsDiscontinuity();
+            discontinuity |= _listenerDiscontinuity.exchange(false);
+
+            for (auto i = 0; i < _packetListeners.size(); ++i)
+            {
+                _packetListeners[i]->OnPacket(streamIndex, packet, discontinuity);
+            }
+        }
+
+        bool AVLibRTSPSource::IsCompatible(const Live555RTSPClient& client, 
+            const Live555RTSPClient& other)
+        {
+            if (client.SubsessionCount() != other.SubsessionCount())
+            {
+                return false;
+            }
+
+            for (auto i = 0; i < client.SubsessionCount(); ++i)
+            {
+                auto parameters = client.SubsessionStream(i).codecpar;
+                auto otherParameters = other.SubsessionStream(i).codecpar;
+
+                if (parameters->codec_type != otherParameters->codec_type ||
+                    parameters->codec_id != otherParameters->codec_id)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        unique_ptr<AVLibPacket> AVLibRTSPSource::ToAVLibPacket(Live555Packet& live555Packet,
+            int streamIndex, bool prependExtradata)
+        {
+            auto avlibPacket = _recycler.GetPacket();
+            auto& packet = avlibPacket->Packet();
+            auto parameters = _rtspClient->SubsessionStream(streamIndex).codecpar;
+
+            if (prependExtradata && parameters->extradata_size > 0)
+            {
+                // parameter sets ahead of the keyframe reconfigure the running decoder
+                // for the new profile's resolution
+                auto size = parameters->extradata_size + live555Packet.DataSize();
+                packet.buf = av_buffer_alloc(size + AV_INPUT_BUFFER_PADDING_SIZE);
+
+                if (packet.buf != nullptr)
+                {
+                    memcpy(packet.buf->data, parameters->extradata, parameters->extradata_size);
+                    memcpy(packet.buf->data + parameters->extradata_size, live555Packet.Data(),
+                        live555Packet.DataSize());
+                    memset(packet.buf->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+                    packet.data = packet.buf->data;
+                    packet.size = size;
+                }
+            }
+            else
+            {
+                // the avlib packet takes its own reference to the received buffer
+                packet.buf = av_buffer_ref(live555Packet.Buffer());
+                packet.data = live555Packet.Data();
+                packet.size = live555Packet.DataSize();
+            }
+
+            packet.pts = live555Packet.PresentationTime();
+            packet.stream_index = streamIndex;
+
+            if (packet.buf == nullptr)
+            {
+                Debug::LogError("AVLibRTSPSource::ToAVLibPacket - failed to reference packet buffer");
+                _recycler.Recycle(move(avlibPacket));
+                return nullptr;
+            }
+
+            return avlibPacket;
         }
     }
 }
\ No newline at end of file
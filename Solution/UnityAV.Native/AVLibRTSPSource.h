@@ -2,9 +2,13 @@
 
 #include "IAVLibSource.h"
 #include "AVLibPacketRecycler.h"
+#include "AVLibPacketRing.h"
+#include "PlayerOptions.h"
+#include "VideoDescription.h"
 
 #include "Live555Util.h"
 #include "Live555RTSPClient.h"
+#include "Live555Scheduler.h"
 
 namespace UnityAV
 {
@@ -21,8 +25,10 @@ namespace UnityAV
             /**
             * \brief Initializes a new instance of AVLibRTSPSource
             * \param uri The uri of the rtsp stream to read
+            * \param options The options of the owning player
             */
-            explicit AVLibRTSPSource(const string& uri);
+            explicit AVLibRTSPSource(const string& uri, 
+                const PlayerOptions& options = PlayerOptions());
             // Disabled copy constructor
             explicit AVLibRTSPSource(const AVLibRTSPSource&& other) = delete;
             // Disabled copy assignment
@@ -46,40 +52,105 @@ namespace UnityAV
             void Seek(double from, double to) override;
             unique_ptr<AVLibPacket> TryGetNext(int streamIndex) override;
             void Recycle(unique_ptr<AVLibPacket> packet) override;
+            void CollectStatistics(PlayerStatistics& statistics) const override;
+            bool AddProfile(const string& uri, const IVideoDescription& description) override;
+            void SetDisplaySize(const IVideoDescription& description) override;
+            void SetPaused(bool paused) override;
+            void AddPacketListener(IAVLibPacketListener& listener) override;
+            void RemovePacketListener(IAVLibPacketListener& listener) override;
 
         private:
+            typedef unique_ptr<Live555RTSPClient, 
+                Live555RTSPClient::Live555RTSPClientDeleter> ClientPtr;
+
+            /**
+             * \brief An alternative uri of the media and the video it provides
+             */
+            struct Profile
+            {
+                string Uri;
+                VideoDescription Video;
+            };
+
             static const AVStream EmptyStream;
             static const int DefaultPacketQueueSize;            
+            static const int64_t KeyframeRequestIntervalMicroseconds;
+            static const int64_t ProfileSwitchTimeoutMicroseconds;
+            static const int64_t LiveEdgeMicroseconds;
+            static const int64_t kBytesPerMegabyte;
+
+            bool AwaitsKeyframe(int streamIndex, bool discontinuity, const uint8_t* data, 
+                int size);
+            ClientPtr CreateClient(int profile);
+            int SelectProfile() const;
+            void UpdateProfileSwitch();
+            void SwitchProfile();
+            void AbandonProfileSwitch();
+            static bool IsCompatible(const Live555RTSPClient& client, 
+                const Live555RTSPClient& other);
+            unique_ptr<AVLibPacket> ToAVLibPacket(Live555Packet& live555Packet, 
+                int streamIndex, bool prependExtradata);
+            unique_ptr<AVLibPacket> TryGetFromRing(int streamIndex);
+            void ResetShiftState();
+            void OnLivePacket(Live555RTSPClient& client, int streamIndex, 
+                Live555Packet& live555Packet);
+            void DrainQueuedPackets(Live555RTSPClient& client);
+            void FeedRing(Live555RTSPClient& client, int streamIndex, 
+                Live555Packet& live555Packet);
+            void NotifyListeners(Live555RTSPClient& client, int streamIndex, 
+                Live555Packet& live555Packet);
 
-            // live555 process wide members
-            static mutex ProcessWideMutex;
-            static atomic_flag ProcessWideInitialized;
-            static int InstanceCount;
-            static thread TaskSchedulerThread;
-            static volatile char WatchVariable;
-            static unique_ptr<BasicUsageEnvironment, 
-                BasicUsageEnvrionmentDeleter> Environment;
-            static unique_ptr<BasicTaskScheduler> TaskScheduler;
-
-            // live555 process wide methods
-            static void ProcessWideInitialize();
-            static void ProcessWideTeardown();
-            static void SchedulerThreadMethod();
-
-            // live555 client
-            unique_ptr<Live555RTSPClient, 
-                Live555RTSPClient::Live555RTSPClientDeleter> _rtspClient;
+            // live555 event loop shared with other sessions
+            shared_ptr<Live555Scheduler> _scheduler;
+
+            // live555 client, guarded as decoding threads and the player thread share it
+            ClientPtr _rtspClient;
+            mutable mutex _clientMutex;
+
+            // profiles, the active one is swapped once the pending one reaches a keyframe
+            vector<Profile> _profiles;
+            VideoDescription _displaySize;
+            mutable mutex _profileMutex;
+            atomic_int _requestedProfile;
+            int _activeProfile;
+            ClientPtr _pendingClient;
+            int _pendingProfile;
+            int64_t _pendingStartTime;
+            bool _pendingKeyframeRequested;
+            unique_ptr<Live555Packet> _switchPacket;
+            int _switchStreamIndex;
 
             // packets
             AVLibPacketRecycler _recycler;
+            PlayerOptions _options;
+
+            // live packets, only the active client's are passed on as they arrive
+            atomic<Live555RTSPClient*> _liveClient;
+            vector<IAVLibPacketListener*> _packetListeners;
+            atomic_bool _listenerDiscontinuity;
+            mutex _listenersMutex;
+
+            // time shift, the live packets feed the ring and streams are read back from
+            // it, at the live edge or paced from a point behind it
+            unique_ptr<AVLibPacketRing> _ring;
+            atomic_bool _ringDiscontinuity;
+            bool _timeShifted;
+            bool _paused;
+            vector<int64_t> _shiftCursors;
+            vector<bool> _shiftSeekPending;
+            vector<unique_ptr<AVLibPacket>> _shiftNext;
+            int64_t _shiftAnchorTime;
+            int64_t _shiftAnchorPosition;
+            int64_t _shiftPosition;
 
-            // streams
-            vector<AVMediaType> _streamTypes;
-            vector<AVStream> _streams;
-            vector<double> _timeBases;
-            vector<double> _frameRates;
+            // keyframe gating, decoding starts and resumes only from keyframes
+            vector<bool> _awaitingKeyframe;
+            bool _requestKeyframes;
+            int64_t _lastKeyframeRequest;
+            mutex _gateMutex;
 
-            string _uri;
+            // meta
+            atomic<int64_t> _framesAwaitingKeyframe, _keyframeRequests;
         };
     }
 }
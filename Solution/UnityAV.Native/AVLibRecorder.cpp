@@ -0,0 +1,385 @@
+﻿#include "stdafx.h"
+#include "AVLibRecorder.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        const int AVLibRecorder::DefaultMaxQueuedPackets = 512;
+        const int64_t AVLibRecorder::MaxGapMicroseconds = 5000000;
+
+        AVLibRecorder::~AVLibRecorder()
+        {
+            // the writer drains the queue before it finishes
+            Finish();
+
+            if (_thread.joinable())
+            {
+                _thread.join();
+            }
+
+            Close();
+
+            if (_droppedPackets.load() > 0 || _failedPackets > 0)
+            {
+                Debug::LogWarning("AVLibRecorder::~AVLibRecorder - %s recorded, %lld packets "
+                    "dropped and %d failed to write", _path.c_str(), _droppedPackets.load(),
+                    _failedPackets);
+            }
+        }
+
+        AVLibRecorder::AVLibRecorder(const string& path, int maxQueuedPackets)
+            : _path(path), _formatContext(nullptr), _headerWritten(false), _keyframeStream(-1),
+            _awaitingKeyframe(false), _checkJump(true), _offset(0), _lastTime(-1),
+            _maxQueuedPackets(static_cast<size_t>(max(maxQueuedPackets, 1))),
+            _overflowed(false), _stopping(false), _failedPackets(0)
+        {
+            _droppedPackets.store(0);
+            _finished.store(false);
+        }
+
+        unique_ptr<AVLibRecorder> AVLibRecorder::Create(const string& path,
+            const IAVLibSource& source, int maxQueuedPackets)
+        {
+            if (path.empty())
+            {
+                Debug::LogError("AVLibRecorder::Create - path was empty");
+                return nullptr;
+            }
+
+            if (!source.IsConnected())
+            {
+                Debug::LogError("AVLibRecorder::Create - source must be connected to be recorded");
+                return nullptr;
+            }
+
+            auto recorder = unique_ptr<AVLibRecorder>(new AVLibRecorder(path, maxQueuedPackets));
+            if (!recorder->Open(source))
+            {
+                return nullptr;
+            }
+
+            recorder->_thread = thread(&AVLibRecorder::WriterThread, recorder.get());
+
+            return recorder;
+        }
+
+        void AVLibRecorder::OnPacket(int streamIndex, const AVPacket& packet, bool discontinuity)
+        {
+            if (streamIndex < 0 || streamIndex >= _outputStreams.size() ||
+                _outputStreams[streamIndex] < 0)
+            {
+                return;
+            }
+
+            lock_guard<mutex> lock(_queueMutex);
+
+            // the writer has fallen behind, dropped packets leave a gap
+            if (_stopping || _queue.size() >= _maxQueuedPackets)
+            {
+                _droppedPackets++;
+                _overflowed = true;
+                return;
+            }
+
+            // the packet keeps a reference to the source's data rather than a copy
+            auto queued = CreatePacket(packet);
+            if (queued == nullptr)
+            {
+                _droppedPackets++;
+                _overflowed = true;
+                return;
+            }
+
+            queued->stream_index = streamIndex;
+            _queue.push_back({ move(queued), discontinuity || _overflowed });
+            _overflowed = false;
+
+            _queueCondition.notify_one();
+        }
+
+        const string& AVLibRecorder::Path() const
+        {
+            return _path;
+        }
+
+        void AVLibRecorder::Finish()
+        {
+            {
+                lock_guard<mutex> lock(_queueMutex);
+                _stopping = true;
+            }
+
+            _queueCondition.notify_all();
+        }
+
+        bool AVLibRecorder::IsFinished() const
+        {
+            return _finished.load();
+        }
+
+        int64_t AVLibRecorder::DroppedPackets() const
+        {
+            return _droppedPackets.load();
+        }
+
+        bool AVLibRecorder::Open(const IAVLibSource& source)
+        {
+            auto result = avformat_alloc_output_context2(&_formatContext, nullptr, nullptr,
+                _path.c_str());
+            if (result < 0 || _formatContext == nullptr)
+            {
+                Debug::LogError("AVLibRecorder::Open - no container matches %s, use .mp4 or "
+                    ".mkv", _path.c_str());
+                return false;
+            }
+
+            // each source stream is copied as it is, without decoding
+            for (auto i = 0; i < source.StreamCount(); ++i)
+            {
+                auto& stream = source.Stream(i);
+                auto type = source.StreamType(i);
+
+                // live sources express time in their own base rather than the stream's
+                auto timeBase = stream.time_base.num > 0 && stream.time_base.den > 0 ?
+                    stream.time_base : av_d2q(source.TimeBase(i), INT_MAX);
+
+                _timeBases.push_back(timeBase);
+                _lastDTS.push_back(AV_NOPTS_VALUE);
+                _outputStreams.push_back(-1);
+
+                if (stream.codecpar == nullptr ||
+                    (type != AVMEDIA_TYPE_VIDEO && type != AVMEDIA_TYPE_AUDIO))
+                {
+                    continue;
+                }
+
+                if (avformat_query_codec(_formatContext->oformat, stream.codecpar->codec_id,
+                    FF_COMPLIANCE_NORMAL) == 0)
+                {
+                    Debug::LogWarning("AVLibRecorder::Open - stream %d's codec can't be stored "
+                        "in %s, it is not recorded", i, _formatContext->oformat->name);
+                    continue;
+                }
+
+                auto outputStream = avformat_new_stream(_formatContext, nullptr);
+                if (outputStream == nullptr ||
+                    avcodec_parameters_copy(outputStream->codecpar, stream.codecpar) < 0)
+                {
+                    Debug::LogError("AVLibRecorder::Open - failed to create output stream");
+                    return false;
+                }
+
+                // the source container's codec tag may not be valid in this one
+                outputStream->codecpar->codec_tag = 0;
+                outputStream->time_base = timeBase;
+                _outputStreams[i] = outputStream->index;
+
+                // the recording starts, and resumes after gaps, on a video keyframe
+                if (type == AVMEDIA_TYPE_VIDEO && _keyframeStream < 0)
+                {
+                    _keyframeStream = i;
+                    _awaitingKeyframe = true;
+                }
+            }
+
+            if (_formatContext->nb_streams == 0)
+            {
+                Debug::LogError("AVLibRecorder::Open - the source has no streams to record");
+                return false;
+            }
+
+            return true;
+        }
+
+        bool AVLibRecorder::WriteHeader()
+        {
+            auto result = 0;
+
+            if (!(_formatContext->oformat->flags & AVFMT_NOFILE))
+            {
+                result = avio_open(&_formatContext->pb, _path.c_str(), AVIO_FLAG_WRITE);
+                if (result < 0)
+                {
+                    auto errbuf = unique_ptr<char[]>(new char[1024]);
+                    av_strerror(result, errbuf.get(), 1024);
+                    Debug::LogError("AVLibRecorder::WriteHeader - failed to open %s: %s",
+                        _path.c_str(), errbuf.get());
+                    return false;
+                }
+            }
+
+            // fragmented mp4 stays playable if recording is cut short
+            auto rawOptions = static_cast<AVDictionary*>(nullptr);
+            auto formatName = string(_formatContext->oformat->name);
+            if (formatName.find("mp4") != string::npos || formatName.find("mov") != string::npos)
+            {
+                av_dict_set(&rawOptions, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+            }
+
+            result = avformat_write_header(_formatContext, &rawOptions);
+            av_dict_free(&rawOptions);
+
+            if (result < 0)
+            {
+                auto errbuf = unique_ptr<char[]>(new char[1024]);
+                av_strerror(result, errbuf.get(), 1024);
+                Debug::LogError("AVLibRecorder::WriteHeader - failed to write the header of "
+                    "%s: %s", _path.c_str(), errbuf.get());
+                return false;
+            }
+
+            _headerWritten = true;
+            Debug::Log("AVLibRecorder::WriteHeader - recording %d streams to %s",
+                _formatContext->nb_streams, _path.c_str());
+
+            return true;
+        }
+
+        void AVLibRecorder::Close()
+        {
+            if (_formatContext == nullptr)
+            {
+                return;
+            }
+
+            if (_headerWritten)
+            {
+                // flush the packets held for interleaving before the trailer
+                av_interleaved_write_frame(_formatContext, nullptr);
+                av_write_trailer(_formatContext);
+            }
+
+            if (!(_formatContext->oformat->flags & AVFMT_NOFILE) && _formatContext->pb != nullptr)
+            {
+                avio_closep(&_formatContext->pb);
+            }
+
+            avformat_free_context(_formatContext);
+            _formatContext = nullptr;
+        }
+
+        void AVLibRecorder::WriterThread()
+        {
+            // packets are still taken if the file can't be written, they're discarded
+            WriteHeader();
+
+            while (true)
+            {
+                auto queued = QueuedPacket();
+
+                {
+                    auto lock = unique_lock<mutex>(_queueMutex);
+                    _queueCondition.wait(lock, [this]()
+                    {
+                        return _stopping || !_queue.empty();
+                    });
+
+                    if (_queue.empty())
+                    {
+                        break;
+                    }
+
+                    queued = move(_queue.front());
+                    _queue.pop_front();
+                }
+
+                if (_headerWritten)
+                {
+                    Write(queued);
+                }
+            }
+
+            Close();
+            _finished.store(true);
+        }
+
+        void AVLibRecorder::Write(QueuedPacket& queued)
+        {
+            auto& packet = *queued.Packet;
+            auto streamIndex = packet.stream_index;
+            auto outputIndex = _outputStreams[streamIndex];
+            auto timeBase = _timeBases[streamIndex];
+
+            if (queued.Discontinuity)
+            {
+                // video can only resume from a keyframe, the timeline is checked for a
+                // jump, such as from a seek, a loop or a reconnection
+                _awaitingKeyframe |= _keyframeStream >= 0;
+                _checkJump = true;
+            }
+
+            if (_awaitingKeyframe)
+            {
+                if (streamIndex != _keyframeStream || !(packet.flags & AV_PKT_FLAG_KEY))
+                {
+                    return;
+                }
+
+                _awaitingKeyframe = false;
+            }
+
+            // live sources only give presentation times
+            if (packet.pts == AV_NOPTS_VALUE)
+            {
+                packet.pts = packet.dts;
+            }
+            if (packet.dts == AV_NOPTS_VALUE)
+            {
+                packet.dts = packet.pts;
+            }
+            if (packet.dts == AV_NOPTS_VALUE)
+            {
+                return;
+            }
+
+            auto pts = av_rescale_q(packet.pts, timeBase, AV_TIME_BASE_Q);
+            auto dts = av_rescale_q(packet.dts, timeBase, AV_TIME_BASE_Q);
+
+            // the recording starts at zero, jumps are closed up so it plays straight on
+            if (_checkJump)
+            {
+                _checkJump = false;
+
+                auto time = dts + _offset;
+                if (_lastTime < 0 || time < _lastTime || time > _lastTime + MaxGapMicroseconds)
+                {
+                    _offset = (_lastTime < 0 ? 0 : _lastTime + 1) - dts;
+                }
+            }
+
+            pts += _offset;
+            dts += _offset;
+            _lastTime = max(_lastTime, dts);
+
+            auto outputTimeBase = _formatContext->streams[outputIndex]->time_base;
+            packet.pts = av_rescale_q(pts, AV_TIME_BASE_Q, outputTimeBase);
+            packet.dts = av_rescale_q(dts, AV_TIME_BASE_Q, outputTimeBase);
+            packet.duration = av_rescale_q(packet.duration, timeBase, outputTimeBase);
+            packet.stream_index = outputIndex;
+            packet.pos = -1;
+
+            // muxers reject decode times which don't increase
+            auto& lastDTS = _lastDTS[streamIndex];
+            if (lastDTS != AV_NOPTS_VALUE && packet.dts <= lastDTS)
+            {
+                packet.dts = lastDTS + 1;
+                packet.pts = max(packet.pts, packet.dts);
+            }
+            lastDTS = packet.dts;
+
+            // the muxer takes the packet's reference
+            auto result = av_interleaved_write_frame(_formatContext, &packet);
+            if (result < 0)
+            {
+                if (_failedPackets++ == 0)
+                {
+                    auto errbuf = unique_ptr<char[]>(new char[1024]);
+                    av_strerror(result, errbuf.get(), 1024);
+                    Debug::LogError("AVLibRecorder::Write - failed to write to %s: %s",
+                        _path.c_str(), errbuf.get());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "AVLibPacket.h"
+#include "IAVLibSource.h"
+#include "IAVLibPacketListener.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for recording the compressed packets of a source to a file,
+         * remuxing them without decoding, the file is opened, written and finished on a
+         * thread of its own so no call blocks on it
+         */
+        class AVLibRecorder : public IAVLibPacketListener
+        {
+        public:
+            static const int DefaultMaxQueuedPackets;
+
+            /**
+             * \brief Deconstructs an instance of AVLibRecorder, the packets queued are
+             * written and the file is finished
+             */
+            virtual ~AVLibRecorder();
+            // Disabled copy constructor
+            explicit AVLibRecorder(const AVLibRecorder&& other) = delete;
+            // Disabled copy assignment
+            AVLibRecorder& operator=(const AVLibRecorder&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibRecorder(AVLibRecorder&& other) = delete;
+            // Disabled move assignment
+            AVLibRecorder& operator=(AVLibRecorder&& other) = delete;
+
+            /**
+             * \brief Creates a recorder of a connected source's streams
+             * \param path The path of the file to record to, the container is chosen by
+             * its extension, mp4 is written fragmented so an interrupted recording plays
+             * \param source The source to take the streams from
+             * \param maxQueuedPackets The number of packets which may wait to be written,
+             * packets beyond it are dropped
+             * \return The recorder, nullptr on failure, failing to open the file is only
+             * logged as it happens on the writer thread
+             */
+            static unique_ptr<AVLibRecorder> Create(const string& path,
+                const IAVLibSource& source, int maxQueuedPackets = DefaultMaxQueuedPackets);
+
+            void OnPacket(int streamIndex, const AVPacket& packet, bool discontinuity) override;
+
+            /**
+             * \brief Evaluates the path being recorded to
+             * \return The path being recorded to
+             */
+            const string& Path() const;
+            /**
+             * \brief Stops taking packets, the packets queued are written and the file is
+             * finished on the writer thread without waiting for it
+             */
+            void Finish();
+            /**
+             * \brief Evaluates if the file has been finished
+             * \return True if the file has been finished, false otherwise
+             */
+            bool IsFinished() const;
+            /**
+             * \brief Evaluates the number of packets dropped as the writer fell behind
+             * \return The number of packets dropped
+             */
+            int64_t DroppedPackets() const;
+
+        private:
+            static const int64_t MaxGapMicroseconds;
+
+            /**
+             * \brief A packet waiting to be written, its stream index is the source's
+             */
+            struct QueuedPacket
+            {
+                unique_ptr<AVPacket, AVPacketDeleter> Packet;
+                bool Discontinuity;
+            };
+
+            explicit AVLibRecorder(const string& path, int maxQueuedPackets);
+
+            bool Open(const IAVLibSource& source);
+            bool WriteHeader();
+            void Close();
+            void WriterThread();
+            void Write(QueuedPacket& queued);
+
+            // output, indexed by the source's streams, -1 when a stream isn't recorded
+            string _path;
+            AVFormatContext* _formatContext;
+            bool _headerWritten;
+            vector<int> _outputStreams;
+            vector<AVRational> _timeBases;
+            vector<int64_t> _lastDTS;
+            int _keyframeStream;
+
+            // timeline, rebased to start from zero and to run on across jumps
+            bool _awaitingKeyframe;
+            bool _checkJump;
+            int64_t _offset;
+            int64_t _lastTime;
+
+            // queue
+            deque<QueuedPacket> _queue;
+            size_t _maxQueuedPackets;
+            bool _overflowed;
+            bool _stopping;
+            mutex _queueMutex;
+            condition_variable _queueCondition;
+            thread _thread;
+
+            atomic_bool _finished;
+
+            // meta
+            atomic<int64_t> _droppedPackets;
+            int _failedPackets;
+        };
+    }
+}
@@ -0,0 +1,67 @@
+﻿#include "stdafx.h"
+#include "AVLibScalingVideoClient.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        AVLibScalingVideoClient::AVLibScalingVideoClient(unique_ptr<IVideoClient> client)
+            : _client(move(client))
+        {
+            _scaledFrame = make_unique<VideoFrame>(Width(), Height(), Format());
+        }
+
+        PixelFormat AVLibScalingVideoClient::Format() const
+        {
+            return _client->Format();
+        }
+
+        int AVLibScalingVideoClient::Width() const
+        {
+            return _client->Width();
+        }
+
+        int AVLibScalingVideoClient::Height() const
+        {
+            return _client->Height();
+        }
+
+        void AVLibScalingVideoClient::OnFrameReady(VideoFrame& frame)
+        {
+            // the decoder may already have produced a matching output
+            if (IVideoDescription::Compatible(frame, *_client))
+            {
+                _client->OnFrameReady(frame);
+                return;
+            }
+
+            // the context is only recreated if the incoming frames change
+            _swsContext = unique_ptr<SwsContext, SwsContextDeleter>(sws_getCachedContext(
+                _swsContext.release(), frame.Width(), frame.Height(), 
+                ToAVPixelFormat(frame.Format()), Width(), Height(), ToAVPixelFormat(Format()),
+                SWS_BILINEAR, nullptr, nullptr, nullptr));
+
+            if (!_swsContext)
+            {
+                Debug::LogError("AVLibScalingVideoClient::OnFrameReady: Unable to create SwsContext");
+                return;
+            }
+
+            auto result = sws_scale(_swsContext.get(), frame.Buffers(), frame.Strides(), 0, 
+                frame.Height(), _scaledFrame->Buffers(), _scaledFrame->Strides());
+
+            if (result != Height())
+            {
+                return;
+            }
+
+            _scaledFrame->SetTime(frame.Time());
+            _client->OnFrameReady(*_scaledFrame);
+        }
+
+        void AVLibScalingVideoClient::Write()
+        {
+            _client->Write();
+        }
+    }
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+#include "IVideoClient.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for converting frames to the size and format of a client
+         * which differs from the size and format being decoded
+         */
+        class AVLibScalingVideoClient : public IVideoClient
+        {
+        public:
+            /**
+             * \brief Initializes a new instance of AVLibScalingVideoClient
+             * \param client The client to convert frames for
+             */
+            explicit AVLibScalingVideoClient(unique_ptr<IVideoClient> client);
+            // Default destructor
+            virtual ~AVLibScalingVideoClient() {}
+            // Disabled copy constructor
+            explicit AVLibScalingVideoClient(const AVLibScalingVideoClient&& other) = delete;
+            // Disabled copy assignment
+            AVLibScalingVideoClient& operator=(const AVLibScalingVideoClient&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibScalingVideoClient(AVLibScalingVideoClient&& other) = delete;
+            // Disabled move assignment
+            AVLibScalingVideoClient& operator=(AVLibScalingVideoClient&& other) = delete;
+
+            PixelFormat Format() const override;
+            int Width() const override;
+            int Height() const override;
+            void OnFrameReady(VideoFrame& frame) override;
+            void Write() override;
+
+        private:
+            unique_ptr<IVideoClient> _client;
+            unique_ptr<SwsContext, SwsContextDeleter> _swsContext;
+            unique_ptr<VideoFrame> _scaledFrame;
+        };
+    }
+}
@@ -0,0 +1,242 @@
+﻿#include "stdafx.h"
+#include "AVLibSharedPlayer.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        mutex AVLibSharedPlayer::RegistryMutex;
+        unordered_map<string, weak_ptr<AVLibPlayer>> AVLibSharedPlayer::Registry;
+        unordered_map<AVLibPlayer*, vector<AVLibSharedPlayer*>> AVLibSharedPlayer::Sharers;
+
+        AVLibSharedPlayer::AVLibSharedPlayer(const string& uri, shared_ptr<AVLibPlayer> player,
+            IVideoClient* client) : Player(uri, nullptr), _player(move(player)), 
+            _client(client), _displayWidth(0), _displayHeight(0), _maxFrameRate(0)
+        {
+            // created under the registry lock
+            Sharers[_player.get()].push_back(this);
+        }
+
+        AVLibSharedPlayer::~AVLibSharedPlayer()
+        {
+            _player->RemoveClient(_client);
+
+            // the shared player is torn down with its last sharing player
+            lock_guard<mutex> lock(RegistryMutex);
+
+            auto& sharers = Sharers[_player.get()];
+            sharers.erase(remove(sharers.begin(), sharers.end(), this), sharers.end());
+
+            // the remaining players no longer have to serve this one
+            if (sharers.empty())
+            {
+                Sharers.erase(_player.get());
+            }
+            else
+            {
+                sharers.front()->ApplyDisplaySize();
+                sharers.front()->ApplyMaxFrameRate();
+            }
+
+            _player.reset();
+        }
+
+        unique_ptr<Player> AVLibSharedPlayer::Create(const string& uri, 
+            unique_ptr<IVideoClient> client, const PlayerOptions& options)
+        {
+            // files on their own timeline can't share decoding, but can share the file
+            if (uri.find(RTSPPrefix) == string::npos && !options.SharedTimeline)
+            {
+                auto ownOptions = options;
+                ownOptions.CacheInMemory = true;
+                ownOptions.ShareDecoding = false;
+
+                return make_unique<AVLibPlayer>(uri, move(client), ownOptions);
+            }
+
+            lock_guard<mutex> lock(RegistryMutex);
+
+            // forget players which have since been released
+            for (auto it = Registry.begin(); it != Registry.end();)
+            {
+                if (it->second.expired())
+                {
+                    it = Registry.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            auto player = Registry[uri].lock();
+
+            if (player)
+            {
+                auto handle = player->AddClient(move(client));
+
+                return unique_ptr<Player>(new AVLibSharedPlayer(uri, move(player), handle));
+            }
+
+            // the first sharing player decides the decoded format
+            auto handle = client.get();
+            player = make_shared<AVLibPlayer>(uri, move(client), options);
+            Registry[uri] = player;
+
+            return unique_ptr<Player>(new AVLibSharedPlayer(uri, move(player), handle));
+        }
+
+        void AVLibSharedPlayer::Play()
+        {
+            _player->Play();
+        }
+
+        void AVLibSharedPlayer::Stop()
+        {
+            _player->Stop();
+        }
+
+        bool AVLibSharedPlayer::CanSeek() const
+        {
+            return _player->CanSeek();
+        }
+
+        void AVLibSharedPlayer::Seek(double to)
+        {
+            _player->Seek(to);
+        }
+
+        bool AVLibSharedPlayer::CanLoop() const
+        {
+            return _player->CanLoop();
+        }
+
+        void AVLibSharedPlayer::SetLoop(bool loop)
+        {
+            _player->SetLoop(loop);
+        }
+
+        bool AVLibSharedPlayer::IsLooping()
+        {
+            return _player->IsLooping();
+        }
+
+        double AVLibSharedPlayer::CurrentTime() const
+        {
+            return _player->CurrentTime();
+        }
+
+        double AVLibSharedPlayer::Duration() const
+        {
+            return _player->Duration();
+        }
+
+        bool AVLibSharedPlayer::IsPlaying() const
+        {
+            return _player->IsPlaying();
+        }
+
+        bool AVLibSharedPlayer::IsRealtime() const
+        {
+            return _player->IsRealtime();
+        }
+
+        bool AVLibSharedPlayer::Enqueue(const string& uri)
+        {
+            return _player->Enqueue(uri);
+        }
+
+        PlayerStatistics AVLibSharedPlayer::Statistics() const
+        {
+            return _player->Statistics();
+        }
+
+        bool AVLibSharedPlayer::AddStreamProfile(const string& uri, int width, int height)
+        {
+            return _player->AddStreamProfile(uri, width, height);
+        }
+
+        void AVLibSharedPlayer::SetDisplaySize(int width, int height)
+        {
+            lock_guard<mutex> lock(RegistryMutex);
+
+            _displayWidth = width;
+            _displayHeight = height;
+            ApplyDisplaySize();
+        }
+
+        void AVLibSharedPlayer::SetMaxFrameRate(double framesPerSecond)
+        {
+            if (framesPerSecond < 0)
+            {
+                Debug::LogError("AVLibSharedPlayer::SetMaxFrameRate - frame rate must not be "
+                    "negative");
+                return;
+            }
+
+            lock_guard<mutex> lock(RegistryMutex);
+
+            _maxFrameRate = framesPerSecond;
+            ApplyMaxFrameRate();
+        }
+
+        bool AVLibSharedPlayer::StartRecording(const string& path)
+        {
+            // the shared source has a single recording, any sharing player controls it
+            return _player->StartRecording(path);
+        }
+
+        void AVLibSharedPlayer::StopRecording()
+        {
+            _player->StopRecording();
+        }
+
+        bool AVLibSharedPlayer::SaveClip(double secondsBefore, double secondsAfter,
+            const string& path)
+        {
+            return _player->SaveClip(secondsBefore, secondsAfter, path);
+        }
+
+        void AVLibSharedPlayer::ApplyDisplaySize() const
+        {
+            // the shared source must cover the largest display of any sharing player
+            auto width = 0;
+            auto height = 0;
+
+            auto& sharers = Sharers[_player.get()];
+            for (auto i = 0; i < sharers.size(); ++i)
+            {
+                width = max(width, sharers[i]->_displayWidth);
+                height = max(height, sharers[i]->_displayHeight);
+            }
+
+            _player->SetDisplaySize(width, height);
+        }
+
+        void AVLibSharedPlayer::ApplyMaxFrameRate() const
+        {
+            // the shared decoding runs at the highest cap, uncapped if any player is
+            auto framesPerSecond = 0.0;
+
+            auto& sharers = Sharers[_player.get()];
+            for (auto i = 0; i < sharers.size(); ++i)
+            {
+                if (sharers[i]->_maxFrameRate <= 0)
+                {
+                    framesPerSecond = 0;
+                    break;
+                }
+
+                framesPerSecond = max(framesPerSecond, sharers[i]->_maxFrameRate);
+            }
+
+            _player->SetMaxFrameRate(framesPerSecond);
+        }
+
+        void AVLibSharedPlayer::Write()
+        {
+            // only this players client, the others are written by their own players
+            _player->Write(_client);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+#include "AVLibPlayer.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for exposing a single client of an AVLibPlayer which is 
+         * shared by every sharing player of the same uri, the shared player lives
+         * for as long as any of its sharing players do
+         */
+        class AVLibSharedPlayer : public Player
+        {
+        public:
+            /**
+             * \brief Creates a sharing player, attaching to an existing player of the 
+             * same uri when there is one
+             * \param uri The uri to load the media from
+             * \param client The video client
+             * \param options The options to create the player with
+             * \return The player instance or a nullptr on failure
+             */
+            static unique_ptr<Player> Create(const string& uri, unique_ptr<IVideoClient> client,
+                const PlayerOptions& options);
+
+            /**
+             * \brief Deconstructs an instance of AVLibSharedPlayer
+             */
+            virtual ~AVLibSharedPlayer();
+
+            void Play() override;
+            void Stop() override;
+            bool CanSeek() const override;
+            void Seek(double to) override;
+            bool CanLoop() const override;
+            void SetLoop(bool loop) override;
+            bool IsLooping() override;
+            double CurrentTime() const override;
+            double Duration() const override;
+            bool IsPlaying() const override;
+            bool IsRealtime() const override;
+            bool Enqueue(const string& uri) override;
+            PlayerStatistics Statistics() const override;
+            bool AddStreamProfile(const string& uri, int width, int height) override;
+            void SetDisplaySize(int width, int height) override;
+            void SetMaxFrameRate(double framesPerSecond) override;
+            bool StartRecording(const string& path) override;
+            void StopRecording() override;
+            bool SaveClip(double secondsBefore, double secondsAfter, const string& path) override;
+            void Write() override;
+
+        private:
+            static mutex RegistryMutex;
+            static unordered_map<string, weak_ptr<AVLibPlayer>> Registry;
+            static unordered_map<AVLibPlayer*, vector<AVLibSharedPlayer*>> Sharers;
+
+            /**
+             * \brief Initializes a new instance of AVLibSharedPlayer
+             * \param uri The uri of the media
+             * \param player The shared player
+             * \param client The handle of this players client in the shared player
+             */
+            explicit AVLibSharedPlayer(const string& uri, shared_ptr<AVLibPlayer> player, 
+                IVideoClient* client);
+
+            void ApplyDisplaySize() const;
+            void ApplyMaxFrameRate() const;
+
+            shared_ptr<AVLibPlayer> _player;
+            IVideoClient* _client;
+
+            // what this player asked of the shared player, which serves them all
+            int _displayWidth;
+            int _displayHeight;
+            double _maxFrameRate;
+        };
+    }
+}
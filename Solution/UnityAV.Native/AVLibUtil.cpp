@@ -124,5 +124,88 @@ namespace UnityAV
 
             return bestStreams;
         }
+
+        bool IsKeyframe(AVCodecID codecId, const uint8_t* data, int size)
+        {
+            // walk the start codes, the unit type follows each
+            for (auto i = 0; i + 3 < size; ++i)
+            {
+                if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1)
+                {
+                    continue;
+                }
+
+                auto header = data[i + 3];
+
+                switch (codecId)
+                {
+                case AV_CODEC_ID_H264:
+                    // idr slice
+                    if ((header & 0x1F) == 5)
+                    {
+                        return true;
+                    }
+                    break;
+                case AV_CODEC_ID_HEVC:
+                    // intra random access point slices
+                    if (((header >> 1) & 0x3F) >= 16 && ((header >> 1) & 0x3F) <= 21)
+                    {
+                        return true;
+                    }
+                    break;
+                case AV_CODEC_ID_MPEG4:
+                    // vop header with an intra coding type
+                    if (header == 0xB6 && i + 4 < size)
+                    {
+                        return (data[i + 4] >> 6) == 0;
+                    }
+                    break;
+                default:
+                    // every frame stands alone
+                    return true;
+                }
+            }
+
+            return codecId != AV_CODEC_ID_H264 && codecId != AV_CODEC_ID_HEVC &&
+                codecId != AV_CODEC_ID_MPEG4;
+        }
+
+        static unique_ptr<AVPacket, AVPacketDeleter> AllocatePacket()
+        {
+            auto packet = unique_ptr<AVPacket, AVPacketDeleter>(
+                static_cast<AVPacket*>(malloc(sizeof(AVPacket))));
+            if (packet == nullptr)
+            {
+                return nullptr;
+            }
+
+            av_init_packet(packet.get());
+            packet->data = nullptr;
+            packet->size = 0;
+
+            return packet;
+        }
+
+        unique_ptr<AVPacket, AVPacketDeleter> CreatePacket(int size)
+        {
+            auto packet = AllocatePacket();
+            if (packet == nullptr || av_new_packet(packet.get(), size) < 0)
+            {
+                return nullptr;
+            }
+
+            return packet;
+        }
+
+        unique_ptr<AVPacket, AVPacketDeleter> CreatePacket(const AVPacket& reference)
+        {
+            auto packet = AllocatePacket();
+            if (packet == nullptr || av_packet_ref(packet.get(), &reference) < 0)
+            {
+                return nullptr;
+            }
+
+            return packet;
+        }
     }
 }
@@ -55,6 +55,64 @@ namespace UnityAV
             }
         };
 
+        /**
+        * \brief Responsible for deletion of AVIOContext instances and their buffers
+        */
+        struct AVIOContextDeleter
+        {
+            void operator()(AVIOContext* context)
+            {
+                av_freep(&context->buffer);
+                av_freep(&context);
+            }
+        };
+
+        /**
+        * \brief Responsible for releasing AVBufferRef instances
+        */
+        struct AVBufferRefDeleter
+        {
+            void operator()(AVBufferRef* buffer)
+            {
+                av_buffer_unref(&buffer);
+            }
+        };
+
+        /**
+        * \brief Responsible for uninitialization of AVBufferPool instances, the pool is
+        * freed once every buffer taken from it has been released
+        */
+        struct AVBufferPoolDeleter
+        {
+            void operator()(AVBufferPool* pool)
+            {
+                av_buffer_pool_uninit(&pool);
+            }
+        };
+
+        /**
+        * \brief Responsible for deletion of AVCodecParameters instances
+        */
+        struct AVCodecParametersDeleter
+        {
+            void operator()(AVCodecParameters* parameters)
+            {
+                avcodec_parameters_free(&parameters);
+            }
+        };
+
+        /**
+        * \brief Responsible for deletion of AVPacket instances
+        */
+        struct AVPacketDeleter
+        {
+            void operator()(AVPacket* packet)
+            {
+                av_packet_unref(packet);
+                free(packet);
+            }
+        };
+
         /**
         * \brief Responsible for deletion of SwsContext instances
         */
@@ -95,5 +153,27 @@ namespace UnityAV
         * \return A map of media types and the corresponding best stream indices
         */
         unordered_map<AVMediaType, int> BestStreamIndices(AVFormatContext& formatContext);
+        /**
+        * \brief Evaluates if a packet can be decoded without any earlier packets, h264 and
+        * h265 packets must be annex b
+        * \param codecId The codec of the packet
+        * \param data The data of the packet
+        * \param size The size of the data
+        * \return True if the packet is a keyframe or the codec has no inter frames
+        */
+        bool IsKeyframe(AVCodecID codecId, const uint8_t* data, int size);
+        /**
+        * \brief Creates a packet with room for its own copy of some data
+        * \param size The size of the data the packet holds
+        * \return The packet on success, otherwise nullptr
+        */
+        unique_ptr<AVPacket, AVPacketDeleter> CreatePacket(int size);
+        /**
+        * \brief Creates a packet referencing the data of another, the data is only copied
+        * if the other packet doesn't own it
+        * \param reference The packet to reference
+        * \return The packet on success, otherwise nullptr
+        */
+        unique_ptr<AVPacket, AVPacketDeleter> CreatePacket(const AVPacket& reference);
     }
 }
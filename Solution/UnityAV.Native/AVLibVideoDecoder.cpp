@@ -7,26 +7,117 @@ namespace UnityAV
     namespace Media
     {
         const int AVLibVideoDecoder::kDefaultVideoFrameQueueSize = 25;
+        const int AVLibVideoDecoder::kLowLatencyVideoFrameQueueSize = 2;
+        const int64_t AVLibVideoDecoder::kBytesPerMegabyte = 1024 * 1024;
+        const double AVLibVideoDecoder::kCapMeasureSeconds = 2.0;
+        const double AVLibVideoDecoder::kCapTolerance = 0.9;
+        const double AVLibVideoDecoder::kCacheMaxSeconds = 3.0;
+        const int AVLibVideoDecoder::kCacheMaxPixels = 1280 * 720;
 
         AVLibVideoDecoder::AVLibVideoDecoder(IAVLibSource& source, unique_ptr
             <AVCodecContext, AVCodecContextDeleter> codecContext, int streamIndex,
-            const IVideoDescription& targetDesc) 
-            : AVLibDecoder(source, move(codecContext), streamIndex),
-            _parsedFrames(kDefaultVideoFrameQueueSize), 
+            const vector<VideoDescription>& targetDescs, const PlayerOptions& options,
+            function<void()> onFrameReady) 
+            : AVLibDecoder(source, move(codecContext), streamIndex, move(onFrameReady)),
+            _lowLatency(options.LowLatency && IsRealtime()),
+            _parsedFrames(_lowLatency ? kLowLatencyVideoFrameQueueSize : kDefaultVideoFrameQueueSize), 
             _readyFrames(kDefaultVideoFrameQueueSize),
-            _completeFramesQueueThreshold(kDefaultVideoFrameQueueSize / 2),
-            _sourceWidth(GetCodecContext().width), _sourceHeight(GetCodecContext().height), 
-            _targetWidth(targetDesc.Width()), _targetHeight(targetDesc.Height()),
-            _targetFormat(targetDesc.Format()), _lastFrame(nullptr), _seekRequestTime(0),
-            _givenFrames(0), _returnedFrames(0), _recycledFrames(0)
+            _completeFramesQueueThreshold(_lowLatency ? kLowLatencyVideoFrameQueueSize / 2 :
+                kDefaultVideoFrameQueueSize / 2),
+            _targetWidth(targetDescs.front().Width()), _targetHeight(targetDescs.front().Height()),
+            _targetFormat(targetDescs.front().Format()), _lastFrame(nullptr), _seekRequestTime(0),
+            _cacheBudget(options.FrameCacheMegabytes * kBytesPerMegabyte),
+            _cacheEnabled(options.CacheDecodedFrames && !IsRealtime()),
+            _cacheAborted(false), _cacheIndex(-1), _lentCacheIndex(-1),
+            _givenFrames(0), _returnedFrames(0), _recycledFrames(0), _skippedFrames(0)
         {
             _seekRequest.test_and_set();
 
-            // the sws context performs the pixel format transform
-            _swsContext = unique_ptr<SwsContext, SwsContextDeleter>(sws_getContext(
-                _sourceWidth, _sourceHeight, GetCodecContext().pix_fmt,
-                _targetWidth, _targetHeight, ToAVPixelFormat(_targetFormat), SWS_BILINEAR,
-                nullptr, nullptr, nullptr));
+            // the first pass is recorded into the cache when caching is enabled, and
+            // only short clips are, as anything else won't fit
+            _cacheEnabled = _cacheEnabled && FitsCache(source.Duration());
+            _cacheRecording = _cacheEnabled;
+            _cacheComplete.store(false);
+            _servingFromCache.store(false);
+            _cacheHits.store(0);
+            _cacheMisses.store(0);
+            _cachedBytes.store(0);
+            _cachedFrameCount.store(0);
+
+            // live frames are scheduled by their presentation time unless latency matters most
+            if (IsRealtime() && !_lowLatency)
+            {
+                _jitterBuffer = make_unique<AVLibJitterBuffer>(options.JitterBufferFactor);
+            }
+
+            // quality is traded for speed when playback falls behind, though not while the
+            // cache records every frame nor at low latency, where stale frames make way
+            _appliedQuality = DECODING_QUALITY_FULL;
+            _decimation.store(0);
+
+            _intraOnly = AVLibIntraDecoderPool::IsIntraOnly(GetCodecContext().codec_id);
+            _maxFrameInterval.store(0);
+            _capStarted = false;
+            _capNextTime = 0;
+            _capCheckedInterval = 0;
+            _capDiscarding = false;
+            _capKeepsNonReference = false;
+            _capMeasureStart = -1;
+            _capMeasuredFrames = 0;
+            _clockTime.store(0);
+            _clockKnown.store(false);
+            if (options.AdaptiveQuality && !_lowLatency && !_cacheEnabled)
+            {
+                // live frames wait only as long as the jitter buffer holds them
+                _governor = make_unique<AVLibQualityGovernor>(GetFrameDuration(),
+                    IsRealtime() ? 0 : _completeFramesQueueThreshold);
+            }
+
+            // identical outputs share a single conversion
+            auto primary = targetDescs.front();
+            for (auto i = 1; i < targetDescs.size(); ++i)
+            {
+                auto target = targetDescs[i];
+                auto duplicate = IVideoDescription::Compatible(target, primary);
+
+                for (auto j = 0; j < _outputs.size() && !duplicate; ++j)
+                {
+                    duplicate = IVideoDescription::Compatible(target, _outputs[j]);
+                }
+
+                if (!duplicate)
+                {
+                    _outputs.push_back(target);
+                    _outputSwsContexts.push_back(nullptr);
+                }
+            }
+
+            if (!_outputs.empty())
+            {
+                _outputWorkers = make_unique<AVLibWorkerPool>(static_cast<int>(_outputs.size()));
+            }
+
+            // intra only streams decode consecutive frames on several contexts at once
+            auto lanes = options.IntraDecoders > 0 ? options.IntraDecoders : 
+                AVLibIntraDecoderPool::DefaultLaneCount();
+            if (lanes > 1 && _intraOnly)
+            {
+                _laneSwsContexts.resize(lanes);
+                for (auto i = 0; i < lanes; ++i)
+                {
+                    _laneSwsContexts[i].resize(_outputs.size() + 1);
+                }
+
+                _intraPool = AVLibIntraDecoderPool::Create(*source.Stream(streamIndex).codecpar,
+                    lanes, GetCodecContext().lowres,
+                    [this](AVFrame& frame, int lane) { return ConvertOnLane(frame, lane); },
+                    [this](unique_ptr<VideoFrame> frame) { Release(move(frame)); });
+
+                if (_intraPool)
+                {
+                    Debug::Log("AVLibVideoDecoder: Decoding on %d lanes", _intraPool->LaneCount());
+                }
+            }
 
             // begin decoding
             StartDecoding();
@@ -34,21 +125,80 @@ namespace UnityAV
 
         AVLibVideoDecoder::~AVLibVideoDecoder()
         {
-            // terminate all decoding before deconstruction
+            // terminate all decoding before deconstruction, the lanes last as they
+            // take packets from the decoding thread
             StopDecoding();
+            _intraPool.reset();
+        }
+
+        int AVLibVideoDecoder::LowResolution(const AVCodec& codec, const AVCodecContext& context,
+            const vector<VideoDescription>& targets)
+        {
+            if (context.width <= 0 || context.height <= 0)
+            {
+                return 0;
+            }
+
+            auto width = 0;
+            auto height = 0;
+            for (auto i = 0; i < targets.size(); ++i)
+            {
+                width = max(width, targets[i].Width());
+                height = max(height, targets[i].Height());
+            }
+
+            // a smaller frame scales up to a target, so stop before the next step falls short
+            auto lowres = 0;
+            while (lowres < codec.max_lowres && 
+                AV_CEIL_RSHIFT(context.width, lowres + 1) >= width &&
+                AV_CEIL_RSHIFT(context.height, lowres + 1) >= height)
+            {
+                ++lowres;
+            }
+
+            return lowres;
         }
 
         unique_ptr<VideoFrame> AVLibVideoDecoder::TryGetNext(double time)
         {
+            if (_servingFromCache.load())
+            {
+                return TryGetNextCached(time);
+            }
+
+            auto frame = TryGetNextDecoded(time);
+
+            // once the recorded first pass has been fully consumed, serve from the cache
+            if (frame != nullptr && frame->IsEOF() && _cacheComplete.load())
+            {
+                Debug::Log("AVLibVideoDecoder::TryGetNext: Serving %d frames from the cache",
+                    _cachedFrameCount.load());
+                _servingFromCache.store(true);
+            }
+
+            return frame;
+        }
+
+        unique_ptr<VideoFrame> AVLibVideoDecoder::TryGetNextDecoded(double time)
+        {
+            _clockTime.store(time);
+            _clockKnown.store(true);
+
             if(_parsedFrames.Count() <= _completeFramesQueueThreshold)
             {
                 OnNeedMorePackets();
             }
 
-            // if the decoder is realtime, just pop out the next frame
+            // at low latency only the newest frame is worth showing
+            if(_lowLatency)
+            {
+                return TryGetNewest();
+            }
+
+            // if the decoder is realtime, the jitter buffer decides when frames are due
             if(IsRealtime())
             {
-                return _parsedFrames.Pop();
+                return TryGetBuffered();
             }
 
             auto seekRequest = !_seekRequest.test_and_set();
@@ -127,9 +277,21 @@ namespace UnityAV
                         auto swapFrame = move(_lastFrame);
                         _lastFrame = move(nextFrame);
 
+                        if (_governor)
+                        {
+                            _governor->OnPresented(time - swapFrame->Time(), 
+                                static_cast<int>(_parsedFrames.Count()) + 1);
+                        }
+
                         return move(swapFrame);
                     }
 
+                    // nothing newer has been decoded, how late this is shows how far behind
+                    if (_governor)
+                    {
+                        _governor->OnPresented(time - _lastFrame->Time(), 0);
+                    }
+
                     _givenFrames++;
                     return move(_lastFrame);
                 }
@@ -146,6 +308,99 @@ namespace UnityAV
             return nullptr;
         }
 
+        unique_ptr<VideoFrame> AVLibVideoDecoder::TryGetNewest()
+        {
+            auto newest = _parsedFrames.Pop();
+
+            if (newest == nullptr)
+            {
+                return nullptr;
+            }
+
+            // skip over any frames which have been overtaken by a newer one
+            auto next = _parsedFrames.Pop();
+            while (next != nullptr)
+            {
+                Recycle(move(newest));
+                newest = move(next);
+                next = _parsedFrames.Pop();
+                _skippedFrames++;
+            }
+
+            _givenFrames++;
+            return newest;
+        }
+
+        unique_ptr<VideoFrame> AVLibVideoDecoder::TryGetBuffered()
+        {
+            if (_lastFrame == nullptr)
+            {
+                _lastFrame = _parsedFrames.Pop();
+            }
+
+            _jitterBuffer->SetDepth(static_cast<int>(_parsedFrames.Count()) + 
+                (_lastFrame != nullptr ? 1 : 0));
+
+            // hold the frame back until it's due
+            if (_lastFrame == nullptr || !_jitterBuffer->IsDue(_lastFrame->Time()))
+            {
+                return nullptr;
+            }
+
+            // only the newest due frame can be shown, any older due frames are late
+            auto nextFrame = _parsedFrames.Pop();
+            while (nextFrame != nullptr && _jitterBuffer->IsDue(nextFrame->Time()))
+            {
+                Recycle(move(_lastFrame));
+                _jitterBuffer->OnLate();
+                _lastFrame = move(nextFrame);
+                nextFrame = _parsedFrames.Pop();
+            }
+
+            auto dueFrame = move(_lastFrame);
+            _lastFrame = move(nextFrame);
+            _givenFrames++;
+
+            // the jitter buffer decides when live frames are due, lateness is measured
+            // as they're decoded
+            if (_governor)
+            {
+                _governor->OnPresented(0, static_cast<int>(_parsedFrames.Count()));
+            }
+
+            return dueFrame;
+        }
+
+        unique_ptr<VideoFrame> AVLibVideoDecoder::TryGetNextCached(double time)
+        {
+            // past the final frame the clip has ended
+            if (time >= _cachedTimes.back() + GetFrameDuration())
+            {
+                _cacheIndex = -1;
+
+                auto eofFrame = make_unique<VideoFrame>(0, 0, PIXEL_FORMAT_NONE);
+                eofFrame->SetAsEOF();
+
+                return move(eofFrame);
+            }
+
+            // find the last frame which is due
+            auto due = upper_bound(_cachedTimes.begin(), _cachedTimes.end(), time);
+            auto index = max(0, static_cast<int>(due - _cachedTimes.begin()) - 1);
+
+            // nothing to give if the frame is already shown or is still lent out
+            if (index == _cacheIndex || _cachedFrames[index] == nullptr)
+            {
+                return nullptr;
+            }
+
+            _cacheIndex = index;
+            _lentCacheIndex = index;
+            _cacheHits++;
+
+            return move(_cachedFrames[index]);
+        }
+
         void AVLibVideoDecoder::Recycle(unique_ptr<VideoFrame> videoFrame)
         {
             if(videoFrame == nullptr)
@@ -153,6 +408,14 @@ namespace UnityAV
                 return;
             }
 
+            // frames lent from the cache go back into their slot
+            if (_lentCacheIndex >= 0)
+            {
+                _cachedFrames[_lentCacheIndex] = move(videoFrame);
+                _lentCacheIndex = -1;
+                return;
+            }
+
             videoFrame->OnRecycle();
             _readyFrames.Push(move(videoFrame));
             _returnedFrames++;
@@ -163,13 +426,90 @@ namespace UnityAV
             visitor.Visit(*this);
         }
 
+        bool AVLibVideoDecoder::IsServingFromCache() const
+        {
+            return _servingFromCache.load();
+        }
+
+        void AVLibVideoDecoder::CollectStatistics(PlayerStatistics& statistics) const
+        {
+            statistics.CacheHits += _cacheHits.load();
+            statistics.CacheMisses += _cacheMisses.load();
+            statistics.CachedBytes += _cachedBytes.load();
+            statistics.CachedFrames += _cachedFrameCount.load();
+
+            if (_jitterBuffer)
+            {
+                _jitterBuffer->CollectStatistics(statistics);
+            }
+
+            if (_governor)
+            {
+                _governor->CollectStatistics(statistics);
+            }
+        }
+
+        void AVLibVideoDecoder::SetMaxFrameRate(double framesPerSecond)
+        {
+            _maxFrameInterval.store(framesPerSecond > 0 ? 1.0 / framesPerSecond : 0);
+        }
+
         bool AVLibVideoDecoder::CanDecodeMore()
         {
+            // the cache holds everything there is to decode
+            if (_servingFromCache.load())
+            {
+                return false;
+            }
+
+            // packets wait in the source rather than be dropped by full lanes
+            if (_intraPool && !_intraPool->CanSubmit())
+            {
+                return false;
+            }
+
+            // at low latency decoding never waits, stale frames make way instead
+            if (_lowLatency)
+            {
+                return true;
+            }
+
+            // frames still on the lanes need room in the queue too
+            if (_intraPool)
+            {
+                return _parsedFrames.Count() + _intraPool->InFlight() < 
+                    static_cast<size_t>(kDefaultVideoFrameQueueSize);
+            }
+
             return !_parsedFrames.Full();
         }
 
         bool AVLibVideoDecoder::TryDecode(AVLibPacket& packet)
         {
+            auto time = 0.0;
+            auto timed = TryGetPacketTime(packet, time);
+
+            // every frame of an intra only stream stands alone, so those the player has
+            // passed or which are over the cap needn't be decoded at all
+            if (_intraOnly && timed && (IsPast(time) || SkipForFrameRate(time)))
+            {
+                return true;
+            }
+
+            if (_intraPool)
+            {
+                return _intraPool->Submit(packet.Packet());
+            }
+
+            ApplyQuality();
+
+            // of the frames the player has passed only those others refer to are decoded,
+            // the codec knows which they are
+            if (timed && IsPast(time))
+            {
+                GetCodecContext().skip_frame = AVDISCARD_NONREF;
+            }
+
             auto result = avcodec_send_packet(&GetCodecContext(), &packet.Packet());
 
             // if result < 0, there was a decoding failure
@@ -184,6 +524,12 @@ namespace UnityAV
 
         bool AVLibVideoDecoder::TryGetDecodedFrame(AVLibFrame& frame)
         {
+            // the lanes release their frames themselves
+            if (_intraPool)
+            {
+                return false;
+            }
+
             auto result = avcodec_receive_frame(&GetCodecContext(), &frame.Frame());
 
             if(result < 0)
@@ -194,7 +540,7 @@ namespace UnityAV
                     // push an EOF video frame onto the queue
                     auto eofFrame = GetRecycledFrame();
                     eofFrame->SetAsEOF();
-                    _parsedFrames.Push(move(eofFrame));
+                    Release(move(eofFrame));
                     
                     return false;
                 }
@@ -215,36 +561,178 @@ namespace UnityAV
 
         bool AVLibVideoDecoder::TryParse(AVLibFrame& frame)
         {
+            if (SkipForQuality())
+            {
+                frame.Clean();
+                return true;
+            }
+
             // set the pts of the frame
             frame.Frame().pts = av_frame_get_best_effort_timestamp(&frame.Frame());
             auto time = frame.Frame().pts * GetTimeBase();
 
+            if (!_intraOnly)
+            {
+                MeasureReferenceRate(time);
+            }
+
+            // frames over the cap which others refer to are decoded, but never converted
+            if (!_intraOnly && SkipForFrameRate(time))
+            {
+                frame.Clean();
+                return true;
+            }
+
             auto videoFrame = GetRecycledFrame();
             videoFrame->SetTime(time);
-            
-            auto result = sws_scale(_swsContext.get(), frame.Frame().data, 
-                frame.Frame().linesize, 0, _sourceHeight, videoFrame->Buffers(),
-                videoFrame->Strides());
+
+            // the attached outputs are converted in parallel with the frame itself, on
+            // workers which last as long as the decoder
+            auto flags = ScaleFlags();
+            auto& decoded = frame.Frame();
+            auto& target = *videoFrame;
+            auto tasks = vector<AVLibWorkerPool::Task>();
+            tasks.push_back([this, &decoded, &target, flags]()
+            {
+                return Convert(decoded, _swsContext, target, flags);
+            });
+
+            for (auto i = 0; i < videoFrame->OutputCount(); ++i)
+            {
+                auto& output = videoFrame->Output(i);
+                output.SetTime(time);
+
+                tasks.push_back([this, &decoded, &output, i, flags]()
+                {
+                    return Convert(decoded, _outputSwsContexts[i], output, flags);
+                });
+            }
+
+            auto result = _outputWorkers ? _outputWorkers->Run(tasks) : tasks[0]();
 
             // frame must be cleaned after usage
             frame.Clean();
 
-            if(result != _targetHeight)
+            if(!result)
             {
                 return false;
             }
 
-            _parsedFrames.Push(move(videoFrame));
+            Release(move(videoFrame));
 
             return true;
         }
 
+        unique_ptr<VideoFrame> AVLibVideoDecoder::ConvertOnLane(AVFrame& frame, int lane)
+        {
+            if (SkipForQuality())
+            {
+                return nullptr;
+            }
+
+            auto time = av_frame_get_best_effort_timestamp(&frame) * GetTimeBase();
+
+            auto videoFrame = GetRecycledFrame();
+            videoFrame->SetTime(time);
+
+            // the lanes already run in parallel, so the outputs are converted in turn
+            auto flags = ScaleFlags();
+            auto& swsContexts = _laneSwsContexts[lane];
+            auto result = Convert(frame, swsContexts[0], *videoFrame, flags);
+
+            for (auto i = 0; i < videoFrame->OutputCount(); ++i)
+            {
+                auto& output = videoFrame->Output(i);
+                output.SetTime(time);
+
+                result &= Convert(frame, swsContexts[i + 1], output, flags);
+            }
+
+            if (!result)
+            {
+                videoFrame->OnRecycle();
+                _readyFrames.Push(move(videoFrame));
+                return nullptr;
+            }
+
+            return videoFrame;
+        }
+
+        void AVLibVideoDecoder::Release(unique_ptr<VideoFrame> videoFrame)
+        {
+            if (videoFrame->IsEOF())
+            {
+                // the recorded first pass is complete
+                if (_cacheRecording && !_cachedFrames.empty())
+                {
+                    _cacheRecording = false;
+                    _cacheComplete.store(true);
+                }
+
+                _parsedFrames.Push(move(videoFrame));
+                return;
+            }
+
+            auto time = videoFrame->Time();
+
+            if (_cacheEnabled)
+            {
+                _cacheMisses++;
+            }
+
+            if (_cacheRecording)
+            {
+                CacheFrame(*videoFrame);
+            }
+
+            if (_jitterBuffer)
+            {
+                _jitterBuffer->OnArrival(time);
+            }
+
+            if (_governor && IsRealtime())
+            {
+                _governor->OnDecoded(time);
+            }
+
+            // the oldest frame makes way for the newest, it goes back to be reused
+            if (_lowLatency && _parsedFrames.Full())
+            {
+                auto staleFrame = _parsedFrames.Pop();
+
+                if (staleFrame != nullptr)
+                {
+                    staleFrame->OnRecycle();
+                    _readyFrames.Push(move(staleFrame));
+                    _skippedFrames++;
+                }
+            }
+
+            _parsedFrames.Push(move(videoFrame));
+            OnFrameReady();
+
+            // the lanes have room again
+            if (_intraPool)
+            {
+                OnNeedMorePackets();
+            }
+        }
+
         void AVLibVideoDecoder::FlushQueue()
         {
+            // abandon the frames on the lanes before the queue they'd be released to
+            if (_intraPool)
+            {
+                _intraPool->Flush();
+            }
+
             // flush the buffers
             avcodec_flush_buffers(&GetCodecContext());
             // flush the queue
             _parsedFrames.Flush();
+
+            // the cap's schedule starts over with the next frame
+            _capStarted = false;
         }
 
         unique_ptr<VideoFrame> AVLibVideoDecoder::GetRecycledFrame()
@@ -253,7 +741,7 @@ namespace UnityAV
 
             if (frame == nullptr)
             {
-                frame = make_unique<VideoFrame>(_targetWidth, _targetHeight, _targetFormat);
+                frame = CreateFrame();
             }
             else
             {
@@ -263,17 +751,314 @@ namespace UnityAV
             return move(frame);
         }
 
+        unique_ptr<VideoFrame> AVLibVideoDecoder::CreateFrame() const
+        {
+            auto frame = make_unique<VideoFrame>(_targetWidth, _targetHeight, _targetFormat);
+
+            for (auto i = 0; i < _outputs.size(); ++i)
+            {
+                frame->AttachOutput(make_unique<VideoFrame>(_outputs[i].Width(), 
+                    _outputs[i].Height(), _outputs[i].Format()));
+            }
+
+            return frame;
+        }
+
+        bool AVLibVideoDecoder::Convert(const AVFrame& frame, 
+            unique_ptr<SwsContext, SwsContextDeleter>& context, VideoFrame& target,
+            int flags)
+        {
+            // the context is recreated only if the decoded frames change shape
+            context = unique_ptr<SwsContext, SwsContextDeleter>(sws_getCachedContext(
+                context.release(), frame.width, frame.height, 
+                static_cast<AVPixelFormat>(frame.format), target.Width(), target.Height(),
+                ToAVPixelFormat(target.Format()), flags, nullptr, nullptr, nullptr));
+
+            if (!context)
+            {
+                Debug::LogError("AVLibVideoDecoder::Convert: Unable to create SwsContext");
+                return false;
+            }
+
+            auto result = sws_scale(context.get(), frame.data, frame.linesize, 0, 
+                frame.height, target.Buffers(), target.Strides());
+
+            return result == target.Height();
+        }
+
+        DecodingQuality AVLibVideoDecoder::CurrentQuality() const
+        {
+            return _governor ? _governor->Quality() : DECODING_QUALITY_FULL;
+        }
+
+        void AVLibVideoDecoder::ApplyQuality()
+        {
+            auto quality = CurrentQuality();
+
+            // read by the codec as each frame is decoded, so they apply from the next packet
+            auto& codecContext = GetCodecContext();
+            codecContext.skip_loop_filter = quality >= DECODING_QUALITY_SKIP_LOOP_FILTER ?
+                AVDISCARD_ALL : AVDISCARD_DEFAULT;
+            _capDiscarding = quality < DECODING_QUALITY_SKIP_NONREF && CapSkipsNonReference();
+            codecContext.skip_frame = quality >= DECODING_QUALITY_SKIP_NONREF ||
+                _capDiscarding ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+
+            if (quality == _appliedQuality)
+            {
+                return;
+            }
+
+            Debug::Log("AVLibVideoDecoder::ApplyQuality: Decoding quality %s to level %d",
+                quality > _appliedQuality ? "lowered" : "raised", quality);
+            _appliedQuality = quality;
+        }
+
+        bool AVLibVideoDecoder::SkipForQuality()
+        {
+            // every other frame is dropped before it costs a conversion
+            return CurrentQuality() >= DECODING_QUALITY_HALF_FRAME_RATE && 
+                (_decimation++ & 1) != 0;
+        }
+
+        int AVLibVideoDecoder::ScaleFlags() const
+        {
+            return CurrentQuality() >= DECODING_QUALITY_FAST_SCALING ? 
+                SWS_FAST_BILINEAR : SWS_BILINEAR;
+        }
+
+        bool AVLibVideoDecoder::SkipForFrameRate(double time)
+        {
+            auto interval = _maxFrameInterval.load();
+            if (interval <= 0)
+            {
+                return false;
+            }
+
+            // a little slack keeps a cap at the stream's own rate from skipping any
+            auto slack = GetFrameDuration() / 4;
+
+            // frames are kept on a schedule of the cap, jumps off it start it over
+            if (_capStarted && time < _capNextTime - slack && _capNextTime - time <= interval)
+            {
+                return true;
+            }
+
+            _capNextTime = _capStarted && time - _capNextTime <= interval ? 
+                _capNextTime + interval : time + interval;
+            _capStarted = true;
+
+            return false;
+        }
+
+        bool AVLibVideoDecoder::TryGetPacketTime(AVLibPacket& packet, double& time) const
+        {
+            auto& avPacket = packet.Packet();
+            auto timestamp = avPacket.pts != AV_NOPTS_VALUE ? avPacket.pts : avPacket.dts;
+
+            if (timestamp == AV_NOPTS_VALUE)
+            {
+                return false;
+            }
+
+            time = timestamp * GetTimeBase();
+            return true;
+        }
+
+        bool AVLibVideoDecoder::IsPast(double time) const
+        {
+            // live frames are due by the jitter buffer rather than the clock, and the
+            // cache needs every frame of the pass it records
+            if (IsRealtime() || _cacheRecording || !_clockKnown.load())
+            {
+                return false;
+            }
+
+            // a frame is passed once the clock is beyond the whole of its duration
+            return time + GetFrameDuration() <= _clockTime.load();
+        }
+
+        bool AVLibVideoDecoder::CapSkipsNonReference()
+        {
+            auto interval = _maxFrameInterval.load();
+
+            // a new cap is measured afresh
+            if (interval != _capCheckedInterval)
+            {
+                _capCheckedInterval = interval;
+                _capKeepsNonReference = false;
+                _capMeasureStart = -1;
+            }
+
+            // at half the stream's rate or less frames no others refer to may be discarded,
+            // so long as the frames which are decoded regardless still meet the cap
+            return !_capKeepsNonReference && interval > 0 && GetFrameRate() > 0 &&
+                GetFrameRate() * interval >= 2;
+        }
+
+        void AVLibVideoDecoder::MeasureReferenceRate(double time)
+        {
+            if (!_capDiscarding || _capKeepsNonReference)
+            {
+                _capMeasureStart = -1;
+                return;
+            }
+
+            // jumps back, such as loops and seeks, start the measurement over
+            if (_capMeasureStart < 0 || time < _capMeasureStart)
+            {
+                _capMeasureStart = time;
+                _capMeasuredFrames = 0;
+                return;
+            }
+
+            _capMeasuredFrames++;
+
+            auto span = time - _capMeasureStart;
+            if (span < kCapMeasureSeconds)
+            {
+                return;
+            }
+
+            // groups of pictures with few frames others refer to, such as ibbp, leave too
+            // few to meet the cap, so every frame is decoded and the cap thins them instead
+            auto capped = span / _capCheckedInterval;
+            if (_capMeasuredFrames < capped * kCapTolerance)
+            {
+                Debug::Log("AVLibVideoDecoder::MeasureReferenceRate: %.1f reference frames a "
+                    "second fall short of the cap, decoding every frame", 
+                    _capMeasuredFrames / span);
+                _capKeepsNonReference = true;
+            }
+
+            _capMeasureStart = time;
+            _capMeasuredFrames = 0;
+        }
+
+        bool AVLibVideoDecoder::FitsCache(double duration)
+        {
+            auto& context = GetCodecContext();
+
+            if (duration <= 0 || duration > kCacheMaxSeconds)
+            {
+                Debug::Log("AVLibVideoDecoder::FitsCache: Clip of %.1fs is too long to "
+                    "cache, at most %.1fs is", duration, kCacheMaxSeconds);
+                return false;
+            }
+
+            if (context.width * context.height > kCacheMaxPixels)
+            {
+                Debug::Log("AVLibVideoDecoder::FitsCache: Clip of %dx%d is too large to "
+                    "cache, at most 720p is", context.width, context.height);
+                return false;
+            }
+
+            // every frame of the clip is held at the size of the target
+            auto frameSize = av_image_get_buffer_size(ToAVPixelFormat(_targetFormat),
+                _targetWidth, _targetHeight, 1);
+            auto frameDuration = GetFrameDuration();
+            auto frames = frameDuration > 0 ? ceil(duration / frameDuration) : 0.0;
+
+            if (frameSize <= 0 || frames <= 0 || frames * frameSize > _cacheBudget)
+            {
+                Debug::Log("AVLibVideoDecoder::FitsCache: Clip exceeds the %d MB frame "
+                    "cache budget", static_cast<int>(_cacheBudget / kBytesPerMegabyte));
+                return false;
+            }
+
+            return true;
+        }
+
+        void AVLibVideoDecoder::CacheFrame(const VideoFrame& frame)
+        {
+            auto size = frame.TotalSize();
+
+            // stop caching for good once the clip doesn't fit
+            if (_cachedBytes.load() + size > _cacheBudget)
+            {
+                Debug::LogWarning("AVLibVideoDecoder::CacheFrame: Clip exceeds the %d MB "
+                    "frame cache budget, caching stopped", 
+                    static_cast<int>(_cacheBudget / kBytesPerMegabyte));
+                ClearCache();
+                _cacheRecording = false;
+                _cacheAborted = true;
+                return;
+            }
+
+            auto cachedFrame = CreateFrame();
+            cachedFrame->CopyFrom(frame);
+
+            _cachedTimes.push_back(frame.Time());
+            _cachedFrames.push_back(move(cachedFrame));
+            _cachedBytes += size;
+            _cachedFrameCount++;
+        }
+
+        void AVLibVideoDecoder::ClearCache()
+        {
+            _cachedFrames.clear();
+            _cachedTimes.clear();
+            _cachedBytes.store(0);
+            _cachedFrameCount.store(0);
+        }
+
         void AVLibVideoDecoder::OnEOF()
         {
+            // the eof marker follows the frames still on the lanes
+            if (_intraPool)
+            {
+                auto eofFrame = GetRecycledFrame();
+                eofFrame->SetAsEOF();
+                _intraPool->SubmitMarker(move(eofFrame));
+                return;
+            }
+
             // sending a nullptr to the decoder notifies it that it's eof
             auto result = avcodec_send_packet(&GetCodecContext(), nullptr);
         }
 
+        void AVLibVideoDecoder::OnFlush()
+        {
+            // frames from before the interruption are stale, the pool is kept
+            FlushQueue();
+
+            if (_jitterBuffer)
+            {
+                _jitterBuffer->Reset();
+            }
+
+            if (_governor)
+            {
+                _governor->Reset();
+            }
+        }
+
         void AVLibVideoDecoder::OnSeek(double to)
         {
             // flush the queue
             FlushQueue();
 
+            if (_jitterBuffer)
+            {
+                _jitterBuffer->Reset();
+            }
+
+            // frames are late while catching up with a seek, that isn't overload
+            if (_governor)
+            {
+                _governor->Reset();
+            }
+
+            // a partially recorded cache is only valid when recording from the start
+            if (_cacheEnabled && !_cacheAborted && !_cacheComplete.load())
+            {
+                ClearCache();
+                _cacheRecording = to <= 0;
+            }
+
+            // the clock moves to the seek before the player next asks for a frame
+            _clockTime.store(to);
+            _clockKnown.store(true);
+
             // cache the time and mark that there is a request
             _seekRequestTime = to;
             _seekRequest.clear();            
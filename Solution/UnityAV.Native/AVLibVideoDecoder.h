@@ -1,8 +1,13 @@
 ﻿#pragma once
 #include "AVLibDecoder.h"
 #include "AVLibFrame.h"
+#include "AVLibIntraDecoderPool.h"
+#include "AVLibJitterBuffer.h"
+#include "AVLibQualityGovernor.h"
+#include "AVLibWorkerPool.h"
 #include "FixedSizeQueue.h"
 #include "VideoFrame.h"
+#include "VideoDescription.h"
 
 namespace UnityAV
 {
@@ -21,11 +26,16 @@ namespace UnityAV
              * \param source The source to get packets from
              * \param codecContext The codec context of the stream
              * \param streamIndex The stream index
-             * \param targetDesc The target video description
+             * \param targetDescs The target video descriptions, the first is the frame
+             * itself and any others distinct from it are attached as outputs
+             * \param options The options of the owning player
+             * \param onFrameReady Called by the decoding thread whenever a frame is ready
              */
             explicit AVLibVideoDecoder(IAVLibSource& source, unique_ptr<AVCodecContext,
                 AVCodecContextDeleter> codecContext, int streamIndex, 
-                const IVideoDescription& targetDesc);
+                const vector<VideoDescription>& targetDescs, 
+                const PlayerOptions& options = PlayerOptions(),
+                function<void()> onFrameReady = nullptr);
             virtual ~AVLibVideoDecoder();
 
             /**
@@ -42,7 +52,21 @@ namespace UnityAV
              */
             void Recycle(unique_ptr<VideoFrame> videoFrame);
 
+            /**
+             * \brief Evaluates the largest reduction the codec can decode at, where
+             * each step halves the size of the frame, while still covering every target
+             * \param codec The codec of the stream
+             * \param context The codec context of the stream, not yet opened
+             * \param targets The target video descriptions
+             * \return The lowres factor, zero for full resolution
+             */
+            static int LowResolution(const AVCodec& codec, const AVCodecContext& context,
+                const vector<VideoDescription>& targets);
+
             void Accept(IAVLibDecoderVisitor & visitor) override;
+            bool IsServingFromCache() const override;
+            void CollectStatistics(PlayerStatistics& statistics) const override;
+            void SetMaxFrameRate(double framesPerSecond) override;
 
         protected:
             bool CanDecodeMore() override;
@@ -51,29 +75,102 @@ namespace UnityAV
             bool TryParse(AVLibFrame& frame) override;
             void OnEOF() override;
             void OnSeek(double to) override;
+            void OnFlush() override;
 
         private:
             static const int kDefaultVideoFrameQueueSize;
+            static const int kLowLatencyVideoFrameQueueSize;
+            static const int64_t kBytesPerMegabyte;
+            static const double kCapMeasureSeconds;
+            static const double kCapTolerance;
+            static const double kCacheMaxSeconds;
+            static const int kCacheMaxPixels;
             
             void FlushQueue();
             unique_ptr<VideoFrame> GetRecycledFrame();
+            unique_ptr<VideoFrame> CreateFrame() const;
+            static bool Convert(const AVFrame& frame, 
+                unique_ptr<SwsContext, SwsContextDeleter>& context, VideoFrame& target,
+                int flags);
+            DecodingQuality CurrentQuality() const;
+            void ApplyQuality();
+            bool SkipForQuality();
+            int ScaleFlags() const;
+            bool SkipForFrameRate(double time);
+            bool CapSkipsNonReference();
+            void MeasureReferenceRate(double time);
+            bool TryGetPacketTime(AVLibPacket& packet, double& time) const;
+            bool IsPast(double time) const;
+            unique_ptr<VideoFrame> ConvertOnLane(AVFrame& frame, int lane);
+            void Release(unique_ptr<VideoFrame> videoFrame);
+            unique_ptr<VideoFrame> TryGetNextDecoded(double time);
+            unique_ptr<VideoFrame> TryGetNewest();
+            unique_ptr<VideoFrame> TryGetBuffered();
+            unique_ptr<VideoFrame> TryGetNextCached(double time);
+            bool FitsCache(double duration);
+            void CacheFrame(const VideoFrame& frame);
+            void ClearCache();
 
             // core
+            bool _lowLatency;
             unique_ptr<SwsContext, SwsContextDeleter> _swsContext;
             FixedSizeQueue<unique_ptr<VideoFrame>> _parsedFrames;
             FixedSizeQueue<unique_ptr<VideoFrame>> _readyFrames;
             int _completeFramesQueueThreshold;
-            int _sourceWidth, _sourceHeight;
             int _targetWidth, _targetHeight;
             PixelFormat _targetFormat;
+            vector<VideoDescription> _outputs;
+            vector<unique_ptr<SwsContext, SwsContextDeleter>> _outputSwsContexts;
+            unique_ptr<AVLibWorkerPool> _outputWorkers;
             unique_ptr<VideoFrame> _lastFrame;
+            unique_ptr<AVLibJitterBuffer> _jitterBuffer;
+
+            // parallel decoding of intra only streams, each lane converts on its own
+            unique_ptr<AVLibIntraDecoderPool> _intraPool;
+            vector<vector<unique_ptr<SwsContext, SwsContextDeleter>>> _laneSwsContexts;
+
+            // degrading under load, the applied quality is only touched by the decoding thread
+            unique_ptr<AVLibQualityGovernor> _governor;
+            DecodingQuality _appliedQuality;
+            atomic_int _decimation;
+
+            // capping the frame rate, the schedule is only touched by the decoding thread
+            bool _intraOnly;
+            atomic<double> _maxFrameInterval;
+            bool _capStarted;
+            double _capNextTime;
+
+            // discarding for the cap, given up when the frames others refer to fall short
+            double _capCheckedInterval;
+            bool _capDiscarding;
+            bool _capKeepsNonReference;
+            double _capMeasureStart;
+            int _capMeasuredFrames;
+
+            // the player's clock as of the last frame asked for, so the decoding thread
+            // can skip frames the player has already passed
+            atomic<double> _clockTime;
+            atomic_bool _clockKnown;
 
             // seeking
             atomic_flag _seekRequest = ATOMIC_FLAG_INIT;
             double _seekRequestTime;
 
+            // caching, recorded by the decoding thread until complete, then only
+            // read by the consuming thread
+            vector<unique_ptr<VideoFrame>> _cachedFrames;
+            vector<double> _cachedTimes;
+            int64_t _cacheBudget;
+            bool _cacheEnabled, _cacheRecording, _cacheAborted;
+            atomic_bool _cacheComplete, _servingFromCache;
+            int _cacheIndex, _lentCacheIndex;
+
             // meta
-            int _givenFrames, _returnedFrames, _recycledFrames;
+            int _givenFrames, _returnedFrames;
+            atomic_int _recycledFrames;
+            atomic_int _skippedFrames;
+            atomic<int64_t> _cacheHits, _cacheMisses, _cachedBytes;
+            atomic_int _cachedFrameCount;
         };
     }
 }
@@ -0,0 +1,112 @@
+﻿#include "stdafx.h"
+#include "AVLibWorkerPool.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        AVLibWorkerPool::AVLibWorkerPool(int workerCount) : _running(0), _result(true),
+            _stopping(false)
+        {
+            for (auto i = 0; i < workerCount; ++i)
+            {
+                _workers.push_back(thread(&AVLibWorkerPool::WorkerThread, this));
+            }
+        }
+
+        AVLibWorkerPool::~AVLibWorkerPool()
+        {
+            {
+                lock_guard<mutex> lock(_mutex);
+                _stopping = true;
+            }
+
+            _queuedCondition.notify_all();
+
+            for (auto i = 0; i < _workers.size(); ++i)
+            {
+                if (_workers[i].joinable())
+                {
+                    _workers[i].join();
+                }
+            }
+        }
+
+        bool AVLibWorkerPool::Run(const vector<Task>& tasks)
+        {
+            if (tasks.empty())
+            {
+                return true;
+            }
+
+            // without workers every task runs here in turn
+            if (_workers.empty())
+            {
+                auto result = true;
+                for (auto i = 0; i < tasks.size(); ++i)
+                {
+                    result &= tasks[i]();
+                }
+
+                return result;
+            }
+
+            {
+                lock_guard<mutex> lock(_mutex);
+                _result = true;
+                _running = static_cast<int>(tasks.size()) - 1;
+
+                for (auto i = 1; i < tasks.size(); ++i)
+                {
+                    _queued.push_back(&tasks[i]);
+                }
+            }
+
+            _queuedCondition.notify_all();
+
+            auto result = tasks[0]();
+
+            auto lock = unique_lock<mutex>(_mutex);
+            _doneCondition.wait(lock, [this]()
+            {
+                return _running == 0;
+            });
+
+            return result && _result;
+        }
+
+        void AVLibWorkerPool::WorkerThread()
+        {
+            while (true)
+            {
+                auto task = static_cast<const Task*>(nullptr);
+
+                {
+                    auto lock = unique_lock<mutex>(_mutex);
+                    _queuedCondition.wait(lock, [this]()
+                    {
+                        return _stopping || !_queued.empty();
+                    });
+
+                    if (_stopping)
+                    {
+                        break;
+                    }
+
+                    task = _queued.front();
+                    _queued.pop_front();
+                }
+
+                auto result = (*task)();
+
+                {
+                    lock_guard<mutex> lock(_mutex);
+                    _result &= result;
+                    _running--;
+                }
+
+                _doneCondition.notify_one();
+            }
+        }
+    }
+}
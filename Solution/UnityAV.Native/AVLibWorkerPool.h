@@ -0,0 +1,65 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for running a batch of tasks in parallel on a fixed set of
+         * threads, which live as long as the pool rather than a thread being started for
+         * every task, the calling thread runs the first task itself
+         */
+        class AVLibWorkerPool
+        {
+        public:
+            /**
+             * \brief A task of a batch, returning whether it succeeded
+             */
+            typedef function<bool()> Task;
+
+            /**
+             * \brief Initializes a new instance of AVLibWorkerPool
+             * \param workerCount The number of threads, besides the calling thread
+             */
+            explicit AVLibWorkerPool(int workerCount);
+            /**
+             * \brief Deconstructs an instance of AVLibWorkerPool, waiting for its threads
+             */
+            virtual ~AVLibWorkerPool();
+            // Disabled copy constructor
+            explicit AVLibWorkerPool(const AVLibWorkerPool&& other) = delete;
+            // Disabled copy assignment
+            AVLibWorkerPool& operator=(const AVLibWorkerPool&& other) = delete;
+            // Disabled move constructor
+            explicit AVLibWorkerPool(AVLibWorkerPool&& other) = delete;
+            // Disabled move assignment
+            AVLibWorkerPool& operator=(AVLibWorkerPool&& other) = delete;
+
+            /**
+             * \brief Runs a batch of tasks and waits for all of them, only one batch may
+             * run at a time
+             * \param tasks The tasks to run
+             * \return True if every task succeeded, false otherwise
+             */
+            bool Run(const vector<Task>& tasks);
+
+        private:
+            void WorkerThread();
+
+            // core
+            vector<thread> _workers;
+            deque<const Task*> _queued;
+            int _running;
+            bool _result;
+
+            // threading
+            mutex _mutex;
+            condition_variable _queuedCondition;
+            condition_variable _doneCondition;
+            bool _stopping;
+        };
+    }
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+#include "AVLibUtil.h"
+
+using namespace std;
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Interface for receivers of the compressed packets a source reads,
+         * alongside the packets it hands to decoders
+         */
+        class IAVLibPacketListener
+        {
+        public:
+            // Default destructor
+            virtual ~IAVLibPacketListener(){}
+
+            /**
+             * \brief Called for every packet the source receives, on the thread that
+             * receives it, so it must not block
+             * \param streamIndex The source's index of the packet's stream
+             * \param packet The packet, only valid for the duration of the call, listeners
+             * take their own reference to keep it
+             * \param discontinuity True if the packet doesn't follow on from the previous
+             * packets, such as after data loss, a reconnection or a seek
+             */
+            virtual void OnPacket(int streamIndex, const AVPacket& packet,
+                bool discontinuity) = 0;
+        };
+    }
+}
@@ -1,5 +1,8 @@
 #pragma once
 #include "AVLibPacket.h"
+#include "PlayerStatistics.h"
+#include "IVideoDescription.h"
+#include "IAVLibPacketListener.h"
 
 using namespace std;
 
@@ -90,6 +93,41 @@ namespace UnityAV
             * \param packet The packet to recycle
             */
             virtual void Recycle(unique_ptr<AVLibPacket> packet) = 0;
+            /**
+            * \brief Adds the source's statistics to the given statistics, sources without
+            * any add nothing
+            * \param statistics The statistics to add to
+            */
+            virtual void CollectStatistics(PlayerStatistics& statistics) const {}
+            /**
+            * \brief Adds an alternative profile of the media, served from another uri
+            * \param uri The uri of the profile
+            * \param description The video the profile provides
+            * \return True if the profile was added, false otherwise
+            */
+            virtual bool AddProfile(const string& uri, const IVideoDescription& description) = 0;
+            /**
+            * \brief Informs the source of the size the media is displayed at, letting it
+            * pick the smallest profile that still covers it
+            * \param description The displayed size of the media
+            */
+            virtual void SetDisplaySize(const IVideoDescription& description) = 0;
+            /**
+            * \brief Informs the source that playback was paused or resumed, live sources
+            * which keep a time shift window hold their position while paused
+            * \param paused True if paused, false if resumed
+            */
+            virtual void SetPaused(bool paused) = 0;
+            /**
+            * \brief Adds a listener which is given every packet the source receives
+            * \param listener The listener to add, it must be removed before it is destroyed
+            */
+            virtual void AddPacketListener(IAVLibPacketListener& listener) = 0;
+            /**
+            * \brief Removes a listener, it is given no packets once this returns
+            * \param listener The listener to remove
+            */
+            virtual void RemovePacketListener(IAVLibPacketListener& listener) = 0;
         };
     }
 }
@@ -5,15 +5,72 @@ namespace UnityAV
 {
     namespace Media
     {
-        Live555Packet::Live555Packet(unsigned int bufferSize): _dataSize(0)
+        Live555Packet::Live555Packet(): _dataSize(0), _presentationTime(0),
+            _discontinuity(false)
         {
-            _buffer = unique_ptr<uint8_t>(new uint8_t[bufferSize]);
+            
         }
 
-        void Live555Packet::Read(const uint8_t* const data, unsigned dataSize)
+        void Live555Packet::Attach(unique_ptr<AVBufferRef, AVBufferRefDeleter> buffer)
+        {
+            _buffer = move(buffer);
+            _dataSize = 0;
+        }
+
+        bool Live555Packet::HasBuffer() const
+        {
+            return _buffer != nullptr;
+        }
+
+        unsigned Live555Packet::Capacity() const
+        {
+            if (!_buffer)
+            {
+                return 0;
+            }
+
+            return static_cast<unsigned>(_buffer->size - AV_INPUT_BUFFER_PADDING_SIZE);
+        }
+
+        void Live555Packet::OnReceived(unsigned dataSize)
         {
-            memcpy(_buffer.get(), data, dataSize);
             _dataSize = dataSize;
+
+            // avlib decoders may overread into the padding, it must be zeroed
+            memset(_buffer->data + dataSize, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        }
+
+        void Live555Packet::SetPresentationTime(int64_t presentationTime)
+        {
+            _presentationTime = presentationTime;
+        }
+
+        int64_t Live555Packet::PresentationTime() const
+        {
+            return _presentationTime;
+        }
+
+        void Live555Packet::SetDiscontinuity(bool discontinuity)
+        {
+            _discontinuity = discontinuity;
+        }
+
+        bool Live555Packet::IsDiscontinuity() const
+        {
+            return _discontinuity;
+        }
+
+        AVBufferRef* Live555Packet::Buffer()
+        {
+            return _buffer.get();
+        }
+
+        void Live555Packet::OnRecycle()
+        {
+            _buffer.reset();
+            _dataSize = 0;
+            _presentationTime = 0;
+            _discontinuity = false;
         }
 
         unsigned Live555Packet::DataSize() const
@@ -23,7 +80,12 @@ namespace UnityAV
 
         uint8_t* Live555Packet::Data()
         {
-            return _buffer.get();
+            if (!_buffer)
+            {
+                return nullptr;
+            }
+
+            return _buffer->data;
         }
     }
 }
\ No newline at end of file
@@ -1,19 +1,23 @@
 ﻿#pragma once
+#include "AVLibUtil.h"
 
 namespace UnityAV
 {
     namespace Media
     {
+        /**
+         * \brief Responsible for holding a single frame received by live555, the data
+         * is held in a reference counted buffer which avlib packets can share
+         */
         class Live555Packet
         {
         public:
             // Default destructor
             virtual ~Live555Packet(){}
             /**
-             * \brief Initializes a new instance of Live555Packet
-             * \param bufferSize The size of the buffer for the Live555Packet
+             * \brief Initializes a new instance of Live555Packet without a buffer
              */
-            explicit Live555Packet(unsigned int bufferSize);
+            explicit Live555Packet();
             // Disabled move constructor
             Live555Packet(Live555Packet&& other) = delete;
             // Disabled move assignment
@@ -24,11 +28,58 @@ namespace UnityAV
             Live555Packet& operator=(const Live555Packet&& other) = delete;
 
             /**
-             * \brief The packet reads the data and takes it on
-             * \param data The data to read 
-             * \param dataSize The size of the data to read
+             * \brief Gives the packet a buffer to receive into
+             * \param buffer The buffer, must be padded by AV_INPUT_BUFFER_PADDING_SIZE
              */
-            void Read(const uint8_t* const data, unsigned int dataSize);
+            void Attach(unique_ptr<AVBufferRef, AVBufferRefDeleter> buffer);
+            /**
+             * \brief Evaluates if the packet has a buffer to receive into
+             * \return True if the packet has a buffer, false otherwise
+             */
+            bool HasBuffer() const;
+            /**
+             * \brief Evaluates how much data the buffer can receive, excluding padding
+             * \return The capacity of the buffer in bytes
+             */
+            unsigned int Capacity() const;
+            /**
+             * \brief Marks how much data was received into the buffer and zeroes the
+             * padding following it
+             * \param dataSize The size of the data received
+             */
+            void OnReceived(unsigned int dataSize);
+            /**
+             * \brief Sets the presentation time of the received data
+             * \param presentationTime The presentation time in microseconds
+             */
+            void SetPresentationTime(int64_t presentationTime);
+            /**
+             * \brief Evaluates the presentation time of the received data, synchronised
+             * to the senders wall clock once rtcp has been received
+             * \return The presentation time in microseconds
+             */
+            int64_t PresentationTime() const;
+            /**
+             * \brief Marks if data was lost ahead of this packet
+             * \param discontinuity True if data was lost, false otherwise
+             */
+            void SetDiscontinuity(bool discontinuity);
+            /**
+             * \brief Evaluates if data was lost ahead of this packet, in which case 
+             * decoding should resume from the next keyframe
+             * \return True if data was lost, false otherwise
+             */
+            bool IsDiscontinuity() const;
+            /**
+             * \brief Exposes the reference counted buffer of the packet
+             * \return The buffer of the packet
+             */
+            AVBufferRef* Buffer();
+            /**
+             * \brief Performs the needed reset when the packet is recycled, releasing 
+             * the packets reference to its buffer
+             */
+            void OnRecycle();
             /**
              * \brief Evaluates the current size of the data held by the packet
              * \return The size of the data in bytes
@@ -41,8 +92,10 @@ namespace UnityAV
             uint8_t* Data();
 
         private:
-            unique_ptr<uint8_t> _buffer;
+            unique_ptr<AVBufferRef, AVBufferRefDeleter> _buffer;
             unsigned int _dataSize;
+            int64_t _presentationTime;
+            bool _discontinuity;
         };
     }
 }
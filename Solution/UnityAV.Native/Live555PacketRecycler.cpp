@@ -5,15 +5,15 @@ namespace UnityAV
 {
     namespace Media
     {
-        Live555PacketRecycler::Live555PacketRecycler(int maxCount, 
-            unsigned int bufferSize) : _readyPackets(maxCount), _bufferSize(bufferSize),
-            _givenPackets(0), _returnedPackets(0), _recycledPackets(0)
+        Live555PacketRecycler::Live555PacketRecycler(int maxCount) 
+            : _readyPackets(maxCount), _givenPackets(0), _returnedPackets(0), _recycledPackets(0)
         {
 
         }
 
         void Live555PacketRecycler::Recycle(unique_ptr<Live555Packet> packet)
         {
+            packet->OnRecycle();
             _readyPackets.Push(move(packet));
             _returnedPackets++;
         }
@@ -24,7 +24,7 @@ namespace UnityAV
 
             if (packet == nullptr)
             {
-                packet = make_unique<Live555Packet>(_bufferSize);
+                packet = make_unique<Live555Packet>();
             }
             else
             {
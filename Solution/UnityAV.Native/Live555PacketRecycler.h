@@ -18,7 +18,7 @@ namespace UnityAV
             * \brief Initializes a new Live555PacketRecycler
             * \param maxCount the maximum number of packets to keep at once
             */
-            explicit Live555PacketRecycler(int maxCount, unsigned int bufferSize);
+            explicit Live555PacketRecycler(int maxCount);
             // Disabled copy constructor
             explicit Live555PacketRecycler(const Live555PacketRecycler&& other) = delete;
             // Disabled copy assignment
@@ -41,7 +41,6 @@ namespace UnityAV
 
         private:
             FixedSizeQueue<unique_ptr<Live555Packet>> _readyPackets;
-            unsigned int _bufferSize;
 
             // meta
             int _givenPackets, _returnedPackets, _recycledPackets;
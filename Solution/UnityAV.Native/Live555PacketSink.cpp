@@ -8,12 +8,17 @@ namespace UnityAV
         const int Live555PacketSink::DefaultBufferSize = 1280 * 1280;
         const int Live555PacketSink::DefaultPacketQueueSize = 5;
 
-        Live555PacketSink::Live555PacketSink(UsageEnvironment& env, const string& uri)
-            : MediaSink(env), _packetQueue(DefaultPacketQueueSize), 
-            _recycler(DefaultPacketQueueSize, DefaultBufferSize)
+        Live555PacketSink::Live555PacketSink(UsageEnvironment& env, const string& uri,
+            MediaSubsession& subsession, int packetQueueSize, int bufferSize) : MediaSink(env),
+            _rtpSource(subsession.rtpSource()), _codecId(ToAVCodecID(subsession)),
+            _assembleNALUnits(IsNALSubsession(subsession)), _receivedSize(0),
+            _accessUnitTruncated(false), _discontinuity(false),
+            _missingPackets(0), _truncatedFrames(0), _packetQueue(packetQueueSize),
+            _recycler(packetQueueSize)
         {
             _uri = uri;
-            _receiveBuffer = unique_ptr<uint8_t>(new uint8_t[DefaultBufferSize]);
+            _bufferPool = unique_ptr<AVBufferPool, AVBufferPoolDeleter>(av_buffer_pool_init(
+                bufferSize + AV_INPUT_BUFFER_PADDING_SIZE, av_buffer_alloc));
         }
 
         Live555PacketSink::~Live555PacketSink() 
@@ -39,14 +44,108 @@ namespace UnityAV
         void Live555PacketSink::OnNewFrame(unsigned frameSize, unsigned numTruncatedBytes,
             struct timeval presentationTime, unsigned durationInMicroseconds) 
         {
-            auto packet = _recycler.GetPacket();
-            packet->Read(_receiveBuffer.get(), frameSize);
-            _packetQueue.Push(move(packet));
+            _receivedSize += frameSize;
+            _accessUnitTruncated |= numTruncatedBytes > 0;
+            _discontinuity |= DetectLoss();
+
+            if (IsAccessUnitComplete())
+            {
+                // a truncated frame is unusable, its buffer is received into again
+                if (_accessUnitTruncated)
+                {
+                    Debug::LogWarning("Live555PacketSink::OnNewFrame - dropped truncated frame");
+                    _truncatedFrames++;
+                    _discontinuity = true;
+                }
+                else
+                {
+                    _receivingPacket->OnReceived(_receivedSize);
+                    _receivingPacket->SetPresentationTime(static_cast<int64_t>(
+                        presentationTime.tv_sec) * 1000000 + presentationTime.tv_usec);
+                    _receivingPacket->SetDiscontinuity(_discontinuity);
+                    _discontinuity = false;
+
+                    // a packet the callback consumed is done with
+                    if (_packetCallback && _packetCallback(*_receivingPacket))
+                    {
+                        _recycler.Recycle(move(_receivingPacket));
+                    }
+                    else
+                    {
+                        if (_packetQueue.Full())
+                        {
+                            DropStalePackets();
+                        }
+
+                        _packetQueue.Push(move(_receivingPacket));
+                    }
+                }
+
+                _receivedSize = 0;
+                _accessUnitTruncated = false;
+            }
 
             // request the next frame of data:
             continuePlaying();
         }
 
+        void Live555PacketSink::DropStalePackets()
+        {
+            // every frame of an intra only codec stands alone, the oldest can just go
+            if (_codecId != AV_CODEC_ID_H264 && _codecId != AV_CODEC_ID_HEVC &&
+                _codecId != AV_CODEC_ID_MPEG4)
+            {
+                auto stalePacket = _packetQueue.Pop();
+                if (stalePacket != nullptr)
+                {
+                    _recycler.Recycle(move(stalePacket));
+                }
+
+                return;
+            }
+
+            auto queued = vector<unique_ptr<Live555Packet>>();
+            auto packet = _packetQueue.Pop();
+            while (packet != nullptr)
+            {
+                queued.push_back(move(packet));
+                packet = _packetQueue.Pop();
+            }
+
+            // dropping the oldest packet would break the frames after it, so everything
+            // before the newest keyframe goes, which must leave room to be of use
+            auto keyframe = static_cast<int>(queued.size()) - 1;
+            while (keyframe > 0 && !IsKeyframe(_codecId, queued[keyframe]->Data(),
+                queued[keyframe]->DataSize()))
+            {
+                keyframe--;
+            }
+
+            // without a keyframe to keep everything goes and decoding resumes from the
+            // received packet
+            if (keyframe <= 0)
+            {
+                keyframe = static_cast<int>(queued.size());
+                _receivingPacket->SetDiscontinuity(true);
+            }
+            else
+            {
+                queued[keyframe]->SetDiscontinuity(true);
+            }
+
+            for (auto i = 0; i < queued.size(); ++i)
+            {
+                if (i < keyframe)
+                {
+                    _recycler.Recycle(move(queued[i]));
+                }
+                else
+                {
+                    _packetQueue.Push(move(queued[i]));
+                }
+            }
+        }
+
         unique_ptr<Live555Packet> Live555PacketSink::TryGetNext()
         {
             return _packetQueue.Pop();
@@ -63,6 +162,40 @@ namespace UnityAV
             _recycler.Recycle(move(packet));
         }
 
+        bool Live555PacketSink::DetectLoss()
+        {
+            if (_rtpSource == nullptr)
+            {
+                return false;
+            }
+
+            auto stats = _rtpSource->receptionStatsDB().lookup(_rtpSource->lastReceivedSSRC());
+
+            if (stats == nullptr)
+            {
+                return false;
+            }
+
+            // live555 drops frames which lost a fragment, the count of missing packets
+            // rising is the only sign
+            auto missing = static_cast<int64_t>(stats->totNumPacketsExpected()) - 
+                static_cast<int64_t>(stats->totNumPacketsReceived());
+            auto lost = missing > _missingPackets;
+            _missingPackets = missing;
+
+            return lost;
+        }
+
+        int64_t Live555PacketSink::TruncatedFrames() const
+        {
+            return _truncatedFrames;
+        }
+
+        void Live555PacketSink::SetPacketCallback(function<bool(Live555Packet&)> callback)
+        {
+            _packetCallback = move(callback);
+        }
+
         bool Live555PacketSink::continuePlaying()
         {
             // sanity check (should not happen)
@@ -72,11 +205,70 @@ namespace UnityAV
                 return false;
             }
 
+            if (!PrepareReceivingPacket())
+            {
+                return false;
+            }
+
+            auto data = _receivingPacket->Data() + _receivedSize;
+            auto capacity = _receivingPacket->Capacity() - _receivedSize;
+
+            // live555 strips the start code of each nal unit, restore it ahead of the unit
+            if (_assembleNALUnits)
+            {
+                if (capacity <= sizeof(kNALStartCode))
+                {
+                    // the access unit has outgrown the buffer, keep receiving to find its end
+                    _accessUnitTruncated = true;
+                    _receivedSize = 0;
+                    data = _receivingPacket->Data();
+                    capacity = _receivingPacket->Capacity();
+                }
+
+                memcpy(data, kNALStartCode, sizeof(kNALStartCode));
+                data += sizeof(kNALStartCode);
+                capacity -= sizeof(kNALStartCode);
+                _receivedSize += sizeof(kNALStartCode);
+            }
+
             // Request the next frame of data from our input source.  "afterGettingFrame()" will get called later, when it arrives:
-            fSource->getNextFrame(_receiveBuffer.get(), DefaultBufferSize, OnNewFrame, 
-                this, onSourceClosure, this);
+            fSource->getNextFrame(data, capacity, OnNewFrame, this, onSourceClosure, this);
 
             return true;
         }
+
+        bool Live555PacketSink::PrepareReceivingPacket()
+        {
+            if (_receivingPacket != nullptr)
+            {
+                return true;
+            }
+
+            auto buffer = unique_ptr<AVBufferRef, AVBufferRefDeleter>(
+                av_buffer_pool_get(_bufferPool.get()));
+
+            if (!buffer)
+            {
+                Debug::LogError("Live555PacketSink::PrepareReceivingPacket - failed to get a pooled buffer");
+                return false;
+            }
+
+            _receivingPacket = _recycler.GetPacket();
+            _receivingPacket->Attach(move(buffer));
+
+            return true;
+        }
+
+        bool Live555PacketSink::IsAccessUnitComplete() const
+        {
+            // every frame is complete when not gathering nal units
+            if (!_assembleNALUnits || _rtpSource == nullptr)
+            {
+                return true;
+            }
+
+            // the rtp marker bit is set on the last packet of an access unit
+            return _rtpSource->curPacketMarkerBit();
+        }
     }
 }
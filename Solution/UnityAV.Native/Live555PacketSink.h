@@ -3,6 +3,7 @@
 // can't be included as part of stdafx, causes problems in avlib code
 #include <MediaSink.hh>
 
+#include "Live555Util.h"
 #include "FixedSizeQueue.h"
 #include "Live555PacketRecycler.h"
 
@@ -22,8 +23,14 @@ namespace UnityAV
             * \brief Initializes a new instance of Live555DummySink
             * \param usageEnvironment The usage environment for the sink
             * \param uri The uri of the stream the sink is receiving
+            * \param subsession The subsession the sink is receiving from
+            * \param packetQueueSize The number of received packets to keep, the oldest
+            * are dropped once full
+            * \param bufferSize The largest frame in bytes the sink can receive
             */
-            explicit Live555PacketSink(UsageEnvironment& usageEnvironment, const string& uri);
+            explicit Live555PacketSink(UsageEnvironment& usageEnvironment, const string& uri,
+                MediaSubsession& subsession, int packetQueueSize = DefaultPacketQueueSize,
+                int bufferSize = DefaultBufferSize);
             // Disabled move constructor
             Live555PacketSink(Live555PacketSink&& other) = delete;
             // Disabled move assignment
@@ -35,13 +42,26 @@ namespace UnityAV
 
             unique_ptr<Live555Packet> TryGetNext();
             void Recycle(unique_ptr<Live555Packet> packet);
+            /**
+             * \brief Evaluates the number of frames dropped for not fitting the buffer
+             * \return The number of truncated frames
+             */
+            int64_t TruncatedFrames() const;
+            /**
+             * \brief Sets a callback shown every complete packet as it is received, on
+             * the event loop and before the packet is queued
+             * \param callback The callback to show packets to, returning true if it
+             * consumed the packet, which is then recycled rather than queued
+             */
+            void SetPacketCallback(function<bool(Live555Packet&)> callback);
+
+            static const int DefaultPacketQueueSize;
+            static const int DefaultBufferSize;
 
         protected:
             bool continuePlaying() override;
 
         private:
-            static const int DefaultBufferSize;
-            static const int DefaultPacketQueueSize;
 
             // static callback method
             static void OnNewFrame(void* clientData, unsigned frameSize, 
@@ -52,10 +72,31 @@ namespace UnityAV
             void OnNewFrame(unsigned frameSize, unsigned numTruncatedBytes,
                 struct timeval presentationTime, unsigned durationInMicroseconds);            
 
-            // core
-            unique_ptr<uint8_t> _receiveBuffer;
+            bool PrepareReceivingPacket();
+            bool IsAccessUnitComplete() const;
+            bool DetectLoss();
+            void DropStalePackets();
+
+            // core, frames are received straight into pooled packet buffers
+            unique_ptr<AVBufferPool, AVBufferPoolDeleter> _bufferPool;
+            unique_ptr<Live555Packet> _receivingPacket;
             string _uri;
 
+            // nal units, start codes are restored and units are gathered into access units
+            RTPSource* _rtpSource;
+            AVCodecID _codecId;
+            bool _assembleNALUnits;
+            unsigned int _receivedSize;
+            bool _accessUnitTruncated;
+
+            // loss, the next packet is marked once packets go missing
+            bool _discontinuity;
+            int64_t _missingPackets;
+
+            // meta
+            int64_t _truncatedFrames;
+            function<bool(Live555Packet&)> _packetCallback;
+
             FixedSizeQueue<unique_ptr<Live555Packet>> _packetQueue;
             Live555PacketRecycler _recycler;
         };
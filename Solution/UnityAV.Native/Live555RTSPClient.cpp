@@ -9,8 +9,15 @@ namespace UnityAV
         const string Live555RTSPClient::DefaultApplicationName = "Live5555RTSPClient";
         const portNumBits Live555RTSPClient::DefaultTunnelOverHttpPort = 0;
         const int Live555RTSPClient::DefaultSocketNumToServer = -1;
-        const int Live555RTSPClient::DefaultTimeoutCheckBeginSeconds = 3;
-        const int Live555RTSPClient::DefaultTimeoutSeconds = 2;
+        const int64_t Live555RTSPClient::DefaultTimeoutCheckBeginMicroseconds = 500000;
+        const int64_t Live555RTSPClient::DefaultTimeoutMicroseconds = 300000;
+        const int Live555RTSPClient::TimeoutPacketIntervals = 4;
+        const int Live555RTSPClient::TimeoutRoundTrips = 3;
+        const AVStream Live555RTSPClient::EmptyStream = AVStream();
+        const int64_t Live555RTSPClient::StatisticsIntervalMicroseconds = 1000000;
+        const int Live555RTSPClient::LowLatencyPacketQueueSize = 2;
+        const int Live555RTSPClient::SidebandPacketQueueSize = 50;
+        const int Live555RTSPClient::SidebandBufferSize = 64 * 1024;
 
         Live555RTSPClient::~Live555RTSPClient()
         {            
@@ -21,18 +28,31 @@ namespace UnityAV
                 _session->envir().taskScheduler().unscheduleDelayedTask(_streamTimerTask);
                 Medium::close(_session);
             }
+
+            envir().taskScheduler().unscheduleDelayedTask(_statisticsTask);
+            _scheduler.Cancel(this);
         }
 
-        Live555RTSPClient::Live555RTSPClient(UsageEnvironment& usageEnvironment, const string& uri)
-            : RTSPClient(usageEnvironment, uri.c_str(), DefaultVerbosityLevel,
+        Live555RTSPClient::Live555RTSPClient(Live555Scheduler& scheduler, const string& uri,
+            const PlayerOptions& options)
+            : RTSPClient(scheduler.Environment(), uri.c_str(), DefaultVerbosityLevel,
             DefaultApplicationName.c_str(), DefaultTunnelOverHttpPort,
             DefaultSocketNumToServer), _subSessionIterator(nullptr), _session(nullptr),
             _subsession(nullptr), _streamTimerTask(nullptr), _duration(0),
             _connected(false), _connecting(false), _connectionFailed(false), 
-            _connectionDropped(false), _checkingConnection(false), _checkStartTime(-1), 
-            _lastServerActivityTime(-1), _beginTimeoutCheck(DefaultTimeoutCheckBeginSeconds),
-            _timeout(DefaultTimeoutSeconds), _packetCount(0), _uri(uri)
+            _connectionDropped(false), _options(options), _uri(uri), _scheduler(scheduler),
+            _lastPacketTime(-1), _statisticsTask(nullptr)
         {
+            _checkingConnection.store(false);
+            _checkStartTime.store(-1);
+            _lastServerActivityTime.store(-1);
+            _packetInterval.store(0);
+            _roundTrip.store(0);
+            _describeSentTime.store(0);
+
+            _packetsReceived.store(0);
+            _packetsLost.store(0);
+            _truncatedFrames.store(0);
         }
 
         void Live555RTSPClient::Connect()
@@ -40,6 +60,7 @@ namespace UnityAV
             if(!_connecting && !_connected)
             {
                 OnConnectionAttempt();
+                _describeSentTime.store(av_gettime_relative());
                 sendDescribeCommand(ContinueAfterDescribe);
             }
         }
@@ -64,6 +85,17 @@ namespace UnityAV
             return static_cast<int>(_subsessions.size());
         }
 
+        const AVStream& Live555RTSPClient::SubsessionStream(int subsessionIndex) const
+        {
+            if (subsessionIndex >= static_cast<int>(_streams.size()))
+            {
+                Debug::LogError("Live555RTSPClient::SubsessionStream - subsessionIndex was out of range");
+                return EmptyStream;
+            }
+
+            return _streams[subsessionIndex];
+        }
+
         unique_ptr<Live555Packet> Live555RTSPClient::TryGetNext(int subsessionIndex)
         {
             if(subsessionIndex >= SubsessionCount())
@@ -79,40 +111,56 @@ namespace UnityAV
 
             auto packet = _packetSinks[subsessionIndex]->TryGetNext();
 
-            time_t currentTime;
-            time(&currentTime);
+            if(packet == nullptr)
+            {
+                CheckConnection();
+            }
+
+            return packet;
+        }
 
-            if(packet == nullptr && _packetCount > 0)
+        void Live555RTSPClient::CheckConnection()
+        {
+            if(!IsConnected())
             {
-                if(!_checkingConnection)
-                {
-                    auto delta = currentTime - _lastServerActivityTime;
+                return;
+            }
 
-                    if (delta > _beginTimeoutCheck)
-                    {
-                        _checkingConnection = true;
-                        time(&_checkStartTime);
-                        sendDescribeCommand(ContinueAfterTimeoutDescribe);
-                    }
-                }
-                else
-                {
-                    auto delta = currentTime - _checkStartTime;
+            auto currentTime = av_gettime_relative();
+
+            // slow streams, such as low frame rate or motion triggered cameras, and slow
+            // servers are given longer before they're taken to have gone
+            auto interval = _packetInterval.load();
+            auto beginTimeoutCheck = max(DefaultTimeoutCheckBeginMicroseconds, 
+                TimeoutPacketIntervals * interval);
+            auto timeout = max(max(DefaultTimeoutMicroseconds, TimeoutPacketIntervals * interval),
+                TimeoutRoundTrips * _roundTrip.load());
+
+            if(!_checkingConnection.load())
+            {
+                auto delta = currentTime - _lastServerActivityTime.load();
 
-                    if(delta > _timeout)
+                // the stream has gone quiet, probe the server to see if it's there
+                if (delta > beginTimeoutCheck)
+                {
+                    _checkStartTime.store(currentTime);
+                    _checkingConnection.store(true);
+                    _scheduler.Post(this, [this]()
                     {
-                        OnConnectionDropped();
-                        _checkingConnection = false;
-                    }
+                        OnProbeRequested(this);
+                    });
                 }
             }
             else
             {
-                _lastServerActivityTime = currentTime;
-                ++_packetCount;
-            }
+                auto delta = currentTime - _checkStartTime.load();
 
-            return packet;
+                if(delta > timeout)
+                {
+                    OnConnectionDropped();
+                    _checkingConnection.store(false);
+                }
+            }
         }
 
         void Live555RTSPClient::Recycle(unique_ptr<Live555Packet> packet, int subsessionIndex)
@@ -126,6 +174,21 @@ namespace UnityAV
             _packetSinks[subsessionIndex]->Recycle(move(packet));
         }
 
+        void Live555RTSPClient::CollectStatistics(PlayerStatistics& statistics) const
+        {
+            statistics.PacketsReceived += _packetsReceived.load();
+            statistics.PacketsLost += _packetsLost.load();
+            statistics.TruncatedFrames += _truncatedFrames.load();
+        }
+
+        void Live555RTSPClient::RequestKeyframe()
+        {
+            _scheduler.Post(this, [this]()
+            {
+                OnKeyframeRequested(this);
+            });
+        }
+
         void Live555RTSPClient::ContinueAfterDescribe(RTSPClient* rawClient, int resultCode,
             char* rawResultString)
         {
@@ -140,6 +203,9 @@ namespace UnityAV
 
             auto client = static_cast<Live555RTSPClient*>(rawClient);
 
+            // probes allow for how long the server takes to answer
+            client->_roundTrip.store(av_gettime_relative() - client->_describeSentTime.load());
+
             if (resultCode != 0)
             {
                 client->OnConnectionFailed();
@@ -186,16 +252,18 @@ namespace UnityAV
             auto client = static_cast<Live555RTSPClient*>(rawClient);
 
             // make sure the client was actually checking it's connection
-            if(!client->_checkingConnection)
+            if(!client->_checkingConnection.load())
             {
                 return;
             }
 
-            // for some reason, adtf server throws a 404 when paused
-            if(resultCode == 404)
+            // the server answered, for some reason adtf server throws a 404 when paused
+            if(resultCode == 0 || resultCode == 404)
             {
-                client->_checkingConnection = false;
-                time(&client->_lastServerActivityTime);
+                auto now = av_gettime_relative();
+                client->_roundTrip.store(now - client->_checkStartTime.load());
+                client->_lastServerActivityTime.store(now);
+                client->_checkingConnection.store(false);
             }
 
             // otherwise the server is refusing / not responding
@@ -220,10 +288,27 @@ namespace UnityAV
                 return;
             }
 
+            // describe the subsession's stream from its sdp
+            auto codecParameters = CreateCodecParameters(*client->_subsession);
+            if (!codecParameters)
+            {
+                client->OnConnectionFailed();
+                return;
+            }
+
+            auto stream = AVStream();
+            stream.index = static_cast<int>(client->_streams.size());
+            stream.nb_frames = 0;
+            stream.codecpar = codecParameters.get();
+
             // cache a pointer to the subsession on the client
             client->_subsessions.push_back(client->_subsession);
+            client->_codecParameters.push_back(move(codecParameters));
+            client->_streams.push_back(stream);
             // create the subsession's sink
-            auto sink = new Live555PacketSink(rawClient->envir(), rawClient->url());            
+            auto sink = new Live555PacketSink(rawClient->envir(), rawClient->url(),
+                *client->_subsession, client->PacketQueueSize(*client->_subsession),
+                client->BufferSize(*client->_subsession));
             if (sink == nullptr)
             {
                 client->OnConnectionFailed();
@@ -233,6 +318,12 @@ namespace UnityAV
             // cache a pointer to the sink on the client
             client->_packetSinks.push_back(sink);
 
+            auto subsessionIndex = static_cast<int>(client->_packetSinks.size()) - 1;
+            sink->SetPacketCallback([client, subsessionIndex](Live555Packet& packet)
+            {
+                return client->OnPacket(subsessionIndex, packet);
+            });
+
             client->_subsession->sink = sink;
             sink->startPlaying(*(client->_subsession->readSource()), OnSubsessionEnded, 
                 client->_subsession);
@@ -268,6 +359,10 @@ namespace UnityAV
             auto client = static_cast<Live555RTSPClient*>(rawClient);
             client->OnConnectionSuccess();
 
+            // begin sampling the reception statistics
+            client->_statisticsTask = client->envir().taskScheduler().scheduleDelayedTask(
+                StatisticsIntervalMicroseconds, OnStatisticsTimerExpired, client);
+
             if(client->_duration > 0)
             {
                 Debug::Log("Live555RTSPClient::ContinueAfterPlay - duration > 0");
@@ -306,16 +401,45 @@ namespace UnityAV
 
             if (client->_subsession != nullptr)
             {
-                if (!client->_subsession->initiate())
+                // unwanted subsessions are never set up, sparing their sockets and bandwidth
+                if (!client->IsWanted(*client->_subsession))
+                {
+                    SetupNextSubsession(rawClient);
+                }
+                else if (!client->_subsession->initiate())
                 {
                     SetupNextSubsession(rawClient);
                 }
                 else
                 {
-                    client->sendSetupCommand(*client->_subsession, ContinueAfterSetup, 
-                        false, false);
+                    auto rtpSource = client->_subsession->rtpSource();
+
+                    // bursts of large frames overflow the default udp socket buffers
+                    auto receiveBufferSize = client->_options.ReceiveBufferKilobytes * 1024;
+                    if (client->_options.Transport != RTSP_TRANSPORT_TCP && rtpSource != nullptr)
+                    {
+                        auto socket = rtpSource->RTPgs()->socketNum();
+                        auto size = increaseReceiveBufferTo(client->envir(), socket,
+                            receiveBufferSize);
+
+                        if (size < static_cast<unsigned>(receiveBufferSize))
+                        {
+                            Debug::LogWarning("Live555RTSPClient::SetupNextSubsession - receive buffer "
+                                "limited to %u bytes", size);
+                        }
+                    }
+
+                    client->sendSetupCommand(*client->_subsession, ContinueAfterSetup, false, 
+                        client->_options.Transport == RTSP_TRANSPORT_TCP,
+                        client->_options.Transport == RTSP_TRANSPORT_MULTICAST);
                 }
             }
+            else if (client->_subsessions.empty())
+            {
+                Debug::LogError("Live555RTSPClient::SetupNextSubsession - the session has no "
+                    "subsessions that can be received");
+                client->OnConnectionFailed();
+            }
             else
             {
                 // all subsessions are up, now we send a rtsp "PLAY" command
@@ -449,6 +573,195 @@ namespace UnityAV
             ShutdownStream(client);
         }
 
+        void Live555RTSPClient::OnStatisticsTimerExpired(void* rawClient)
+        {
+            if (rawClient == nullptr)
+            {
+                Debug::LogError("Live555RTSPClient::OnStatisticsTimerExpired, rawClient was nullptr");
+                return;
+            }
+
+            auto client = static_cast<Live555RTSPClient*>(rawClient);
+            client->UpdateStatistics();
+            client->_statisticsTask = client->envir().taskScheduler().scheduleDelayedTask(
+                StatisticsIntervalMicroseconds, OnStatisticsTimerExpired, client);
+        }
+
+        void Live555RTSPClient::OnKeyframeRequested(void* rawClient)
+        {
+            if (rawClient == nullptr)
+            {
+                Debug::LogError("Live555RTSPClient::OnKeyframeRequested, rawClient was nullptr");
+                return;
+            }
+
+            auto client = static_cast<Live555RTSPClient*>(rawClient);
+
+            // rtcp is carried on the rtsp connection over tcp, which live555 can't feed
+            if (client->_options.Transport == RTSP_TRANSPORT_TCP)
+            {
+                return;
+            }
+
+            for (auto i = 0; i < client->_subsessions.size(); ++i)
+            {
+                client->SendPictureLossIndication(*client->_subsessions[i]);
+            }
+        }
+
+        void Live555RTSPClient::OnProbeRequested(void* rawClient)
+        {
+            if (rawClient == nullptr)
+            {
+                Debug::LogError("Live555RTSPClient::OnProbeRequested, rawClient was nullptr");
+                return;
+            }
+
+            auto client = static_cast<Live555RTSPClient*>(rawClient);
+            client->sendDescribeCommand(ContinueAfterTimeoutDescribe);
+        }
+
+        void Live555RTSPClient::SendPictureLossIndication(MediaSubsession& subsession)
+        {
+            auto rtpSource = subsession.rtpSource();
+            auto rtcpInstance = subsession.rtcpInstance();
+
+            if (rtpSource == nullptr || rtcpInstance == nullptr || 
+                rtcpInstance->RTCPgs() == nullptr)
+            {
+                return;
+            }
+
+            // rfc 4585 payload specific feedback, fmt 1 is a picture loss indication
+            auto senderSSRC = rtpSource->SSRC();
+            auto mediaSSRC = rtpSource->lastReceivedSSRC();
+            unsigned char packet[] =
+            {
+                0x81, 206, 0x00, 0x02,
+                static_cast<unsigned char>(senderSSRC >> 24),
+                static_cast<unsigned char>(senderSSRC >> 16),
+                static_cast<unsigned char>(senderSSRC >> 8),
+                static_cast<unsigned char>(senderSSRC),
+                static_cast<unsigned char>(mediaSSRC >> 24),
+                static_cast<unsigned char>(mediaSSRC >> 16),
+                static_cast<unsigned char>(mediaSSRC >> 8),
+                static_cast<unsigned char>(mediaSSRC)
+            };
+
+            rtcpInstance->RTCPgs()->output(envir(), packet, sizeof(packet));
+        }
+
+        void Live555RTSPClient::SetPacketCallback(function<bool(int, Live555Packet&)> callback)
+        {
+            lock_guard<mutex> lock(_packetCallbackMutex);
+            _packetCallback = move(callback);
+        }
+
+        bool Live555RTSPClient::OnPacket(int subsessionIndex, Live555Packet& packet)
+        {
+            // activity is a packet arriving, whether or not it's ever queued, the interval
+            // between packets is smoothed over the last several
+            auto now = av_gettime_relative();
+            if (_lastPacketTime >= 0)
+            {
+                auto interval = _packetInterval.load();
+                auto gap = now - _lastPacketTime;
+                _packetInterval.store(interval > 0 ? (interval * 7 + gap) / 8 : gap);
+            }
+
+            _lastPacketTime = now;
+            _lastServerActivityTime.store(now);
+
+            lock_guard<mutex> lock(_packetCallbackMutex);
+
+            return _packetCallback && _packetCallback(subsessionIndex, packet);
+        }
+
+        bool Live555RTSPClient::IsWanted(MediaSubsession& subsession) const
+        {
+            auto mediumName = string(subsession.mediumName());
+
+            if (mediumName == "audio")
+            {
+                return _options.ReceiveAudio;
+            }
+
+            if (mediumName != "video")
+            {
+                return _options.ReceiveData;
+            }
+
+            // video nothing can decode is not worth receiving
+            auto parameters = CreateCodecParameters(subsession);
+            if (!parameters || parameters->codec_id == AV_CODEC_ID_NONE ||
+                avcodec_find_decoder(parameters->codec_id) == nullptr)
+            {
+                Debug::LogWarning("Live555RTSPClient::IsWanted - skipping video subsession "
+                    "with unsupported codec %s", subsession.codecName());
+                return false;
+            }
+
+            return true;
+        }
+
+        int Live555RTSPClient::PacketQueueSize(MediaSubsession& subsession) const
+        {
+            // audio and metadata arrive as many small frames, so their queues run deeper
+            if (string(subsession.mediumName()) != "video")
+            {
+                return SidebandPacketQueueSize;
+            }
+
+            return _options.LowLatency ? LowLatencyPacketQueueSize :
+                Live555PacketSink::DefaultPacketQueueSize;
+        }
+
+        int Live555RTSPClient::BufferSize(MediaSubsession& subsession) const
+        {
+            if (string(subsession.mediumName()) != "video")
+            {
+                return SidebandBufferSize;
+            }
+
+            return Live555PacketSink::DefaultBufferSize;
+        }
+
+        void Live555RTSPClient::UpdateStatistics()
+        {
+            auto received = int64_t(0);
+            auto lost = int64_t(0);
+            auto truncated = int64_t(0);
+
+            for (auto i = 0; i < _subsessions.size(); ++i)
+            {
+                auto rtpSource = _subsessions[i]->rtpSource();
+
+                if (rtpSource != nullptr)
+                {
+                    RTPReceptionStatsDB::Iterator iterator(rtpSource->receptionStatsDB());
+                    RTPReceptionStats* stats;
+
+                    while ((stats = iterator.next(True)) != nullptr)
+                    {
+                        auto expected = static_cast<int64_t>(stats->totNumPacketsExpected());
+                        auto arrived = static_cast<int64_t>(stats->totNumPacketsReceived());
+
+                        received += arrived;
+                        lost += max(int64_t(0), expected - arrived);
+                    }
+                }
+            }
+
+            for (auto i = 0; i < _packetSinks.size(); ++i)
+            {
+                truncated += _packetSinks[i]->TruncatedFrames();
+            }
+
+            _packetsReceived.store(received);
+            _packetsLost.store(lost);
+            _truncatedFrames.store(truncated);
+        }
+
         void Live555RTSPClient::OnConnectionAttempt()
         {
             Debug::Log("Opening connection to %s", _uri.c_str());
@@ -470,6 +783,10 @@ namespace UnityAV
         void Live555RTSPClient::OnConnectionSuccess()
         {
             Debug::Log("Successfully Connected to %s", _uri.c_str());
+            // silence is measured from connecting until the first packet arrives
+            _lastServerActivityTime.store(av_gettime_relative());
+            _lastPacketTime = -1;
+            _checkingConnection.store(false);
             _connected = true;
             _connectionFailed = false;
             _connecting = false;
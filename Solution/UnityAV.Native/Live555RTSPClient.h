@@ -3,7 +3,12 @@
 // can't be included as part of stdafx, causes problems in avlib code
 #include <RTSPClient.hh>
 
+#include "Live555Util.h"
 #include "Live555PacketSink.h"
+#include "Live555Scheduler.h"
+#include "PlayerOptions.h"
+#include "PlayerStatistics.h"
+#include "RTSPTransport.h"
 
 namespace UnityAV
 {
@@ -29,10 +34,14 @@ namespace UnityAV
 
             /**
              * \brief Initializes a new instance of Live555RTSPClient
-             * \param usageEnvironment The usage environment for the client
+             * \param scheduler The scheduler whose event loop runs the client, it must
+             * outlive the client
              * \param uri The uri of the rtsp stream
+             * \param options The options deciding the subsessions set up, their queue
+             * sizes and the transport of the session
              */
-            explicit Live555RTSPClient(UsageEnvironment& usageEnvironment, const string& uri);
+            explicit Live555RTSPClient(Live555Scheduler& scheduler, const string& uri,
+                const PlayerOptions& options = PlayerOptions());
             // Disabled move constructor
             explicit Live555RTSPClient(Live555RTSPClient&& other) = delete;
             // Disabled move assignment
@@ -66,18 +75,48 @@ namespace UnityAV
              * \return The number of subsessions the client has
              */
             int SubsessionCount() const;
+            /**
+             * \brief Evaluates the stream of a subsession, described by its sdp
+             * \param subsessionIndex The subsession to evaluate the stream for
+             * \return The stream of the subsession
+             */
+            const AVStream& SubsessionStream(int subsessionIndex) const;
             /**
              * \brief Attempts to get the next packet
              * \param subsessionIndex The subsession to get the packet for
              * \return A live555 packet on success, otherwise nullptr
              */
             unique_ptr<Live555Packet> TryGetNext(int subsessionIndex);
+            /**
+             * \brief Probes the server once the stream has gone quiet for longer than its
+             * packets are apart, and marks the connection dropped if it doesn't answer,
+             * called by TryGetNext whenever nothing is queued
+             */
+            void CheckConnection();
             /**
              * \brief Recycles a live555 packet for reuse
              * \param subsessionIndex The subsession the packet belongs to
              * \param packet The live555 packet to reuse
              */
             void Recycle(unique_ptr<Live555Packet> packet, int subsessionIndex);
+            /**
+             * \brief Adds the clients reception statistics to the given statistics
+             * \param statistics The statistics to add to
+             */
+            void CollectStatistics(PlayerStatistics& statistics) const;
+            /**
+             * \brief Sets a callback shown every packet of every subsession as it is
+             * received, it runs on the event loop, safe to call from any thread
+             * \param callback The callback to show packets to, empty to remove it, returning
+             * true if it consumed the packet, which is then not queued
+             */
+            void SetPacketCallback(function<bool(int, Live555Packet&)> callback);
+            /**
+             * \brief Asks the server for a keyframe on every subsession with a rtcp
+             * picture loss indication, only udp sessions support it, safe to call from
+             * any thread
+             */
+            void RequestKeyframe();
 
         protected:
             // Hidden destructor
@@ -88,8 +127,15 @@ namespace UnityAV
             static const string DefaultApplicationName;
             static const portNumBits DefaultTunnelOverHttpPort;
             static const int DefaultSocketNumToServer;
-            static const int DefaultTimeoutCheckBeginSeconds;
-            static const int DefaultTimeoutSeconds;
+            static const int64_t DefaultTimeoutCheckBeginMicroseconds;
+            static const int64_t DefaultTimeoutMicroseconds;
+            static const int TimeoutPacketIntervals;
+            static const int TimeoutRoundTrips;
+            static const AVStream EmptyStream;
+            static const int64_t StatisticsIntervalMicroseconds;
+            static const int LowLatencyPacketQueueSize;
+            static const int SidebandPacketQueueSize;
+            static const int SidebandBufferSize;
 
             // rtsp response handlers
             static void ContinueAfterDescribe(RTSPClient* rawClient, int resultCode,
@@ -111,12 +157,21 @@ namespace UnityAV
             static void OnSubsessionEnded(void* clientData);
             static void OnSubsessionBye(void* clientData);
             static void OnStreamTimerExpired(void* clientData);
+            static void OnStatisticsTimerExpired(void* clientData);
+            static void OnKeyframeRequested(void* clientData);
+            static void OnProbeRequested(void* clientData);
             
             void OnConnectionAttempt();
             void OnConnectionFailed();
             void OnConnectionSuccess();
             void OnConnectionClosed();
             void OnConnectionDropped();
+            void UpdateStatistics();
+            void SendPictureLossIndication(MediaSubsession& subsession);
+            bool OnPacket(int subsessionIndex, Live555Packet& packet);
+            bool IsWanted(MediaSubsession& subsession) const;
+            int PacketQueueSize(MediaSubsession& subsession) const;
+            int BufferSize(MediaSubsession& subsession) const;
 
             // core
             MediaSubsessionIterator* _subSessionIterator;
@@ -128,19 +183,34 @@ namespace UnityAV
             // subsessions and their sinks
             vector<MediaSubsession*> _subsessions;
             vector<Live555PacketSink*> _packetSinks;
+            vector<unique_ptr<AVCodecParameters, AVCodecParametersDeleter>> _codecParameters;
+            vector<AVStream> _streams;
+            function<bool(int, Live555Packet&)> _packetCallback;
+            mutex _packetCallbackMutex;
 
             // connection
             bool _connected;
             bool _connecting;
             bool _connectionFailed;
             bool _connectionDropped;
-            bool _checkingConnection;
-            time_t _checkStartTime;
-            time_t _lastServerActivityTime;
-            int64_t _beginTimeoutCheck;
-            int64_t _timeout;
-            int64_t _packetCount;
+            PlayerOptions _options;
             string _uri;
+
+            // transport, requests from other threads are posted to the scheduler
+            Live555Scheduler& _scheduler;
+
+            // dropout detection, timed by the monotonic clock in microseconds
+            atomic_bool _checkingConnection;
+            atomic<int64_t> _checkStartTime;
+            atomic<int64_t> _lastServerActivityTime;
+            atomic<int64_t> _packetInterval;
+            atomic<int64_t> _roundTrip;
+            atomic<int64_t> _describeSentTime;
+            int64_t _lastPacketTime;
+
+            // meta, sampled on the event loop
+            TaskToken _statisticsTask;
+            atomic<int64_t> _packetsReceived, _packetsLost, _truncatedFrames;
         };
     }
 }
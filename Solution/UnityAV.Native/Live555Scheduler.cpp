@@ -0,0 +1,137 @@
+﻿#include "stdafx.h"
+#include "Live555Scheduler.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        const int Live555Scheduler::kMaxPoolSize = 8;
+
+        mutex Live555Scheduler::PoolMutex;
+        vector<weak_ptr<Live555Scheduler>> Live555Scheduler::Pool;
+
+        Live555Scheduler::Live555Scheduler() : _watchVariable(0)
+        {
+            // the task scheduler should not exit the eventloop, zero does the job
+            _taskScheduler = unique_ptr<BasicTaskScheduler>(BasicTaskScheduler::createNew());
+            _environment = unique_ptr<BasicUsageEnvironment,
+                BasicUsageEnvrionmentDeleter>(BasicUsageEnvironment::createNew(*_taskScheduler));
+            _taskTrigger = _taskScheduler->createEventTrigger(OnTasksPosted);
+            if (_taskTrigger == 0)
+            {
+                Debug::LogError("Live555Scheduler - failed to create the task event trigger");
+            }
+            _thread = thread(&Live555Scheduler::ThreadMethod, this);
+        }
+
+        Live555Scheduler::~Live555Scheduler()
+        {
+            // notify the task scheduler to exit the eventloop, nonzero does the job
+            _watchVariable = -1;
+
+            // enter the event loop thread to ensure it exits before moving on
+            if (_thread.joinable())
+            {
+                _thread.join();
+            }
+
+            _taskScheduler->deleteEventTrigger(_taskTrigger);
+            _environment.reset();
+            _taskScheduler.reset();
+        }
+
+        shared_ptr<Live555Scheduler> Live555Scheduler::Acquire()
+        {
+            lock_guard<mutex> lock(PoolMutex);
+
+            if (Pool.empty())
+            {
+                Pool.resize(PoolSize());
+            }
+
+            // the load of a scheduler is the number of sessions holding it, a torn 
+            // down scheduler has no load
+            auto leastLoaded = 0;
+            for (auto i = 1; i < Pool.size(); ++i)
+            {
+                if (Pool[i].use_count() < Pool[leastLoaded].use_count())
+                {
+                    leastLoaded = i;
+                }
+            }
+
+            auto scheduler = Pool[leastLoaded].lock();
+
+            if (!scheduler)
+            {
+                scheduler = make_shared<Live555Scheduler>();
+                Pool[leastLoaded] = scheduler;
+            }
+
+            return scheduler;
+        }
+
+        UsageEnvironment& Live555Scheduler::Environment()
+        {
+            return *_environment;
+        }
+
+        void Live555Scheduler::Post(const void* owner, function<void()> task)
+        {
+            {
+                lock_guard<mutex> lock(_tasksMutex);
+                _tasks.push_back(make_pair(owner, move(task)));
+            }
+
+            _taskScheduler->triggerEvent(_taskTrigger, this);
+        }
+
+        void Live555Scheduler::Cancel(const void* owner)
+        {
+            lock_guard<mutex> lock(_tasksMutex);
+
+            _tasks.erase(remove_if(_tasks.begin(), _tasks.end(), 
+                [owner](const pair<const void*, function<void()>>& task)
+            {
+                return task.first == owner;
+            }), _tasks.end());
+        }
+
+        void Live555Scheduler::RunTasks()
+        {
+            // tasks run holding the lock, so an owner cancelling them waits one out
+            lock_guard<mutex> lock(_tasksMutex);
+
+            while (!_tasks.empty())
+            {
+                auto task = move(_tasks.front().second);
+                _tasks.pop_front();
+                task();
+            }
+        }
+
+        void Live555Scheduler::OnTasksPosted(void* rawScheduler)
+        {
+            if (rawScheduler == nullptr)
+            {
+                Debug::LogError("Live555Scheduler::OnTasksPosted - rawScheduler was nullptr");
+                return;
+            }
+
+            static_cast<Live555Scheduler*>(rawScheduler)->RunTasks();
+        }
+
+        int Live555Scheduler::PoolSize()
+        {
+            // leave cores free for decoding, which costs far more than receiving
+            auto cores = static_cast<int>(thread::hardware_concurrency());
+            return max(1, min(kMaxPoolSize, cores / 2));
+        }
+
+        void Live555Scheduler::ThreadMethod()
+        {
+            // enter the event loop
+            _taskScheduler->doEventLoop(&_watchVariable);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include "Live555Util.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief Responsible for running a live555 event loop on its own thread, rtsp 
+         * sessions are spread across a pool of schedulers so no one thread carries 
+         * every session's socket reads and callbacks
+         */
+        class Live555Scheduler
+        {
+        public:
+            /**
+             * \brief Deconstructs an instance of Live555Scheduler, stopping its event loop
+             */
+            virtual ~Live555Scheduler();
+            /**
+             * \brief Initializes a new instance of Live555Scheduler, starting its event loop
+             */
+            explicit Live555Scheduler();
+            // Disabled copy constructor
+            explicit Live555Scheduler(const Live555Scheduler&& other) = delete;
+            // Disabled copy assignment
+            Live555Scheduler& operator=(const Live555Scheduler&& other) = delete;
+            // Disabled move constructor
+            explicit Live555Scheduler(Live555Scheduler&& other) = delete;
+            // Disabled move assignment
+            Live555Scheduler& operator=(Live555Scheduler&& other) = delete;
+
+            /**
+             * \brief Acquires the least loaded scheduler of the process wide pool, a 
+             * scheduler is torn down once its last session releases it
+             * \return The scheduler
+             */
+            static shared_ptr<Live555Scheduler> Acquire();
+            /**
+             * \brief Exposes the usage environment which runs on the scheduler
+             * \return The usage environment
+             */
+            UsageEnvironment& Environment();
+            /**
+             * \brief Runs a task on the event loop, safe to call from any thread, every
+             * client shares the scheduler's one event trigger as live555 has so few
+             * \param owner The owner of the task, whose tasks may be cancelled
+             * \param task The task to run, it may not post tasks itself
+             */
+            void Post(const void* owner, function<void()> task);
+            /**
+             * \brief Cancels the tasks an owner has posted which haven't run, waiting
+             * for one which is running, safe to call from any thread
+             * \param owner The owner of the tasks
+             */
+            void Cancel(const void* owner);
+
+        private:
+            static const int kMaxPoolSize;
+
+            static int PoolSize();
+
+            // the process wide pool
+            static mutex PoolMutex;
+            static vector<weak_ptr<Live555Scheduler>> Pool;
+
+            void ThreadMethod();
+            void RunTasks();
+            static void OnTasksPosted(void* rawScheduler);
+
+            // core
+            unique_ptr<BasicTaskScheduler> _taskScheduler;
+            unique_ptr<BasicUsageEnvironment, BasicUsageEnvrionmentDeleter> _environment;
+
+            // threading
+            thread _thread;
+            volatile char _watchVariable;
+
+            // tasks posted from other threads, run in turn by the event trigger
+            EventTriggerId _taskTrigger;
+            deque<pair<const void*, function<void()>>> _tasks;
+            mutex _tasksMutex;
+        };
+    }
+}
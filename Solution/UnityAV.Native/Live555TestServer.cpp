@@ -0,0 +1,608 @@
+﻿#include "stdafx.h"
+#include "Live555TestServer.h"
+
+#include <list>
+#include <random>
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        namespace
+        {
+            const int64_t kMaxLinkQueueMicroseconds = 1000000;
+            const unsigned kMaxFrameSize = 2000000;
+            const unsigned kDefaultEstimatedKilobitsPerSecond = 4000;
+
+            /**
+             * \brief Responsible for emulating the network a session's packets cross,
+             * dropping, queueing and delaying them before they are sent
+             */
+            class NetworkGroupsock : public Groupsock
+            {
+            public:
+                explicit NetworkGroupsock(UsageEnvironment& env, const in_addr& addr, Port port,
+                    const Live555TestStream& stream) : Groupsock(env, addr, port, 255),
+                    _packetLoss(stream.PacketLoss),
+                    _jitter(static_cast<int64_t>(stream.JitterMilliseconds) * 1000),
+                    _bytesPerSecond(static_cast<int64_t>(stream.MaxKilobitsPerSecond) * 125),
+                    _linkFreeTime(0), _random(ntohs(port.num()))
+                {
+
+                }
+
+                virtual ~NetworkGroupsock()
+                {
+                    for (auto it = _delayedPackets.begin(); it != _delayedPackets.end(); ++it)
+                    {
+                        env().taskScheduler().unscheduleDelayedTask((*it)->Task);
+                    }
+                }
+
+                Boolean output(UsageEnvironment& env, unsigned char* buffer, unsigned bufferSize,
+                    DirectedNetInterface* interfaceNotToFwdBackTo) override
+                {
+                    if (_packetLoss > 0 && _chance(_random) < _packetLoss)
+                    {
+                        return True;
+                    }
+
+                    auto delay = static_cast<int64_t>(0);
+
+                    // the link sends one packet at a time, a full queue drops them
+                    if (_bytesPerSecond > 0)
+                    {
+                        auto now = av_gettime_relative();
+                        if (_linkFreeTime - now > kMaxLinkQueueMicroseconds)
+                        {
+                            return True;
+                        }
+
+                        _linkFreeTime = max(_linkFreeTime, now) +
+                            bufferSize * 1000000LL / _bytesPerSecond;
+                        delay = _linkFreeTime - now;
+                    }
+
+                    if (_jitter > 0)
+                    {
+                        delay += static_cast<int64_t>(_chance(_random) * _jitter);
+                    }
+
+                    if (delay <= 0)
+                    {
+                        return Groupsock::output(env, buffer, bufferSize, interfaceNotToFwdBackTo);
+                    }
+
+                    auto packet = make_unique<DelayedPacket>();
+                    packet->Socket = this;
+                    packet->Data.assign(buffer, buffer + bufferSize);
+                    packet->Task = env.taskScheduler().scheduleDelayedTask(delay,
+                        OnDelayedPacket, packet.get());
+                    _delayedPackets.push_back(move(packet));
+
+                    return True;
+                }
+
+            private:
+                /**
+                 * \brief A packet held back by the network
+                 */
+                struct DelayedPacket
+                {
+                    NetworkGroupsock* Socket;
+                    vector<unsigned char> Data;
+                    TaskToken Task;
+                };
+
+                static void OnDelayedPacket(void* clientData)
+                {
+                    auto packet = static_cast<DelayedPacket*>(clientData);
+                    auto& socket = *packet->Socket;
+
+                    socket.Groupsock::output(socket.env(), packet->Data.data(),
+                        static_cast<unsigned>(packet->Data.size()));
+
+                    socket._delayedPackets.remove_if([packet](const unique_ptr<DelayedPacket>& p)
+                    {
+                        return p.get() == packet;
+                    });
+                }
+
+                double _packetLoss;
+                int64_t _jitter;
+                int64_t _bytesPerSecond;
+                int64_t _linkFreeTime;
+                list<unique_ptr<DelayedPacket>> _delayedPackets;
+                mt19937 _random;
+                uniform_real_distribution<double> _chance;
+            };
+
+            /**
+             * \brief Responsible for delivering a file held in memory as a byte stream
+             * which loops forever
+             */
+            class LoopingByteStreamSource : public FramedSource
+            {
+            public:
+                explicit LoopingByteStreamSource(UsageEnvironment& env,
+                    shared_ptr<const vector<uint8_t>> data) : FramedSource(env),
+                    _data(data), _position(0)
+                {
+
+                }
+
+            protected:
+                void doGetNextFrame() override
+                {
+                    auto& data = *_data;
+
+                    fFrameSize = static_cast<unsigned>(min<size_t>(fMaxSize,
+                        data.size() - _position));
+                    memcpy(fTo, data.data() + _position, fFrameSize);
+                    _position = (_position + fFrameSize) % data.size();
+
+                    gettimeofday(&fPresentationTime, nullptr);
+                    fDurationInMicroseconds = 0;
+
+                    // delivered from the event loop rather than recursing into the reader
+                    nextTask() = envir().taskScheduler().scheduleDelayedTask(0,
+                        reinterpret_cast<TaskFunc*>(FramedSource::afterGetting), this);
+                }
+
+            private:
+                shared_ptr<const vector<uint8_t>> _data;
+                size_t _position;
+            };
+
+            /**
+             * \brief A jpeg of a mjpeg file, described as rfc 2435 sends it
+             */
+            struct MJPEGFrame
+            {
+                size_t Offset;
+                size_t Size;
+                uint8_t Type;
+                uint8_t Width;
+                uint8_t Height;
+                uint16_t RestartInterval;
+                uint8_t QuantizationTables[128];
+                uint16_t QuantizationTablesLength;
+            };
+
+            /**
+             * \brief A mjpeg file held in memory along with its frames
+             */
+            struct MJPEGClip
+            {
+                vector<uint8_t> Data;
+                vector<MJPEGFrame> Frames;
+            };
+
+            /**
+             * \brief Finds the jpegs of a mjpeg file, only baseline 4:2:0 and 4:2:2 jpegs
+             * with 8 bit tables can be sent, others are skipped
+             */
+            vector<MJPEGFrame> ParseMJPEG(const vector<uint8_t>& data)
+            {
+                auto frames = vector<MJPEGFrame>();
+                auto position = static_cast<size_t>(0);
+
+                while (true)
+                {
+                    // find the start of image
+                    while (position + 1 < data.size() &&
+                        !(data[position] == 0xFF && data[position + 1] == 0xD8))
+                    {
+                        ++position;
+                    }
+
+                    if (position + 1 >= data.size())
+                    {
+                        break;
+                    }
+
+                    auto frame = MJPEGFrame();
+                    auto supported = false;
+                    auto scan = static_cast<size_t>(0);
+                    auto i = position + 2;
+
+                    // walk the segments up to the start of scan
+                    while (scan == 0 && i + 4 <= data.size() && data[i] == 0xFF)
+                    {
+                        auto marker = data[i + 1];
+                        if (marker == 0xFF)
+                        {
+                            ++i;
+                            continue;
+                        }
+
+                        auto segment = i + 4;
+                        auto end = i + 2 + ((data[i + 2] << 8) | data[i + 3]);
+                        if (end > data.size())
+                        {
+                            break;
+                        }
+
+                        switch (marker)
+                        {
+                        case 0xDB:
+                            for (auto j = segment; j < end;)
+                            {
+                                auto precision = data[j] >> 4;
+                                auto table = data[j] & 0x0F;
+                                ++j;
+
+                                if (precision == 0 && table < 2 && j + 64 <= end)
+                                {
+                                    memcpy(frame.QuantizationTables + table * 64, &data[j], 64);
+                                    frame.QuantizationTablesLength = max<uint16_t>(
+                                        frame.QuantizationTablesLength, (table + 1) * 64);
+                                }
+
+                                j += precision == 0 ? 64 : 128;
+                            }
+                            break;
+                        case 0xC0:
+                        case 0xC1:
+                            if (segment + 8 <= end)
+                            {
+                                auto height = (data[segment + 1] << 8) | data[segment + 2];
+                                auto width = (data[segment + 3] << 8) | data[segment + 4];
+                                auto sampling = data[segment + 7];
+
+                                frame.Width = static_cast<uint8_t>((width + 7) / 8);
+                                frame.Height = static_cast<uint8_t>((height + 7) / 8);
+                                frame.Type = sampling == 0x21 ? 0 : 1;
+
+                                supported = (sampling == 0x21 || sampling == 0x22) &&
+                                    width <= 2040 && height <= 2040;
+                            }
+                            break;
+                        case 0xDD:
+                            if (segment + 2 <= end)
+                            {
+                                frame.RestartInterval = static_cast<uint16_t>(
+                                    (data[segment] << 8) | data[segment + 1]);
+                            }
+                            break;
+                        case 0xDA:
+                            scan = end;
+                            break;
+                        default:
+                            break;
+                        }
+
+                        i = end;
+                    }
+
+                    if (scan == 0)
+                    {
+                        position += 2;
+                        continue;
+                    }
+
+                    // the scan runs up to the end of image
+                    auto eoi = scan;
+                    while (eoi + 1 < data.size() && !(data[eoi] == 0xFF && data[eoi + 1] == 0xD9))
+                    {
+                        ++eoi;
+                    }
+
+                    if (supported && frame.QuantizationTablesLength > 0)
+                    {
+                        frame.Offset = scan;
+                        frame.Size = eoi - scan;
+                        frame.Type += frame.RestartInterval > 0 ? 64 : 0;
+                        frames.push_back(frame);
+                    }
+
+                    position = eoi + 2;
+                }
+
+                return frames;
+            }
+
+            /**
+             * \brief Responsible for delivering the jpegs of a mjpeg file held in memory
+             * at a steady frame rate, looping forever
+             */
+            class LoopingMJPEGSource : public JPEGVideoSource
+            {
+            public:
+                explicit LoopingMJPEGSource(UsageEnvironment& env,
+                    shared_ptr<const MJPEGClip> clip, int framesPerSecond) :
+                    JPEGVideoSource(env), _clip(clip), _current(0), _next(0),
+                    _frameDuration(1000000 / max(framesPerSecond, 1))
+                {
+                    _nextTime.tv_sec = 0;
+                    _nextTime.tv_usec = 0;
+                }
+
+                u_int8_t type() override { return Current().Type; }
+                // in band quantization tables
+                u_int8_t qFactor() override { return 255; }
+                u_int8_t width() override { return Current().Width; }
+                u_int8_t height() override { return Current().Height; }
+                u_int16_t restartInterval() override { return Current().RestartInterval; }
+
+                u_int8_t const* quantizationTables(u_int8_t& precision, u_int16_t& length) override
+                {
+                    precision = 0;
+                    length = Current().QuantizationTablesLength;
+                    return Current().QuantizationTables;
+                }
+
+            protected:
+                void doGetNextFrame() override
+                {
+                    _current = _next;
+                    _next = (_next + 1) % _clip->Frames.size();
+
+                    auto& frame = Current();
+                    fFrameSize = static_cast<unsigned>(min<size_t>(frame.Size, fMaxSize));
+                    fNumTruncatedBytes = static_cast<unsigned>(frame.Size - fFrameSize);
+                    memcpy(fTo, _clip->Data.data() + frame.Offset, fFrameSize);
+
+                    // frames are timed from the first, so sending late doesn't drift
+                    if (_nextTime.tv_sec == 0)
+                    {
+                        gettimeofday(&_nextTime, nullptr);
+                    }
+
+                    fPresentationTime = _nextTime;
+                    fDurationInMicroseconds = _frameDuration;
+
+                    _nextTime.tv_usec += _frameDuration;
+                    _nextTime.tv_sec += _nextTime.tv_usec / 1000000;
+                    _nextTime.tv_usec %= 1000000;
+
+                    nextTask() = envir().taskScheduler().scheduleDelayedTask(0,
+                        reinterpret_cast<TaskFunc*>(FramedSource::afterGetting), this);
+                }
+
+            private:
+                const MJPEGFrame& Current() const
+                {
+                    return _clip->Frames[_current];
+                }
+
+                shared_ptr<const MJPEGClip> _clip;
+                size_t _current, _next;
+                unsigned _frameDuration;
+                timeval _nextTime;
+            };
+
+            /**
+             * \brief Responsible for serving a h264 file which loops over an emulated network
+             */
+            class H264TestSubsession : public H264VideoFileServerMediaSubsession
+            {
+            public:
+                explicit H264TestSubsession(UsageEnvironment& env, const Live555TestStream& stream,
+                    shared_ptr<const vector<uint8_t>> data) :
+                    H264VideoFileServerMediaSubsession(env, stream.Path.c_str(), False),
+                    _stream(stream), _data(data)
+                {
+
+                }
+
+            protected:
+                FramedSource* createNewStreamSource(unsigned clientSessionId,
+                    unsigned& estBitrate) override
+                {
+                    estBitrate = kDefaultEstimatedKilobitsPerSecond;
+
+                    // the framer paces the stream by the frame rate of its sps
+                    return H264VideoStreamFramer::createNew(envir(),
+                        new LoopingByteStreamSource(envir(), _data));
+                }
+
+                Groupsock* createGroupsock(const in_addr& addr, Port port) override
+                {
+                    return new NetworkGroupsock(envir(), addr, port, _stream);
+                }
+
+            private:
+                Live555TestStream _stream;
+                shared_ptr<const vector<uint8_t>> _data;
+            };
+
+            /**
+             * \brief Responsible for serving a mjpeg file which loops over an emulated network
+             */
+            class MJPEGTestSubsession : public OnDemandServerMediaSubsession
+            {
+            public:
+                explicit MJPEGTestSubsession(UsageEnvironment& env, const Live555TestStream& stream,
+                    shared_ptr<const MJPEGClip> clip) : OnDemandServerMediaSubsession(env, False),
+                    _stream(stream), _clip(clip)
+                {
+
+                }
+
+            protected:
+                FramedSource* createNewStreamSource(unsigned clientSessionId,
+                    unsigned& estBitrate) override
+                {
+                    estBitrate = kDefaultEstimatedKilobitsPerSecond;
+                    return new LoopingMJPEGSource(envir(), _clip, _stream.FramesPerSecond);
+                }
+
+                RTPSink* createNewRTPSink(Groupsock* rtpGroupsock,
+                    unsigned char rtpPayloadTypeIfDynamic, FramedSource* inputSource) override
+                {
+                    return JPEGVideoRTPSink::createNew(envir(), rtpGroupsock);
+                }
+
+                Groupsock* createGroupsock(const in_addr& addr, Port port) override
+                {
+                    return new NetworkGroupsock(envir(), addr, port, _stream);
+                }
+
+            private:
+                Live555TestStream _stream;
+                shared_ptr<const MJPEGClip> _clip;
+            };
+
+            /**
+             * \brief Reads a whole file
+             */
+            vector<uint8_t> ReadFile(const string& path)
+            {
+                auto file = ifstream(path, ios::binary);
+                return vector<uint8_t>(istreambuf_iterator<char>(file),
+                    istreambuf_iterator<char>());
+            }
+        }
+
+        const int Live555TestServer::DefaultPort = 8554;
+
+        Live555TestServer::Live555TestServer(int port) : _port(port), _server(nullptr),
+            _dropClientsTrigger(0), _watchVariable(0)
+        {
+
+        }
+
+        Live555TestServer::~Live555TestServer()
+        {
+            // notify the task scheduler to exit the eventloop, nonzero does the job
+            _watchVariable = -1;
+
+            if (_thread.joinable())
+            {
+                _thread.join();
+            }
+
+            // the event loop has exited, so the server can be torn down on this thread
+            if (_dropClientsTrigger != 0)
+            {
+                _taskScheduler->deleteEventTrigger(_dropClientsTrigger);
+            }
+
+            if (_server != nullptr)
+            {
+                Medium::close(_server);
+            }
+
+            _environment.reset();
+            _taskScheduler.reset();
+        }
+
+        unique_ptr<Live555TestServer> Live555TestServer::Create(
+            const vector<Live555TestStream>& streams, int port)
+        {
+            auto server = unique_ptr<Live555TestServer>(new Live555TestServer(port));
+            if (!server->Start(streams))
+            {
+                return nullptr;
+            }
+
+            return server;
+        }
+
+        string Live555TestServer::Uri(const string& name) const
+        {
+            return "rtsp://127.0.0.1:" + to_string(_port) + "/" + name;
+        }
+
+        void Live555TestServer::DropClients()
+        {
+            _taskScheduler->triggerEvent(_dropClientsTrigger, this);
+        }
+
+        bool Live555TestServer::Start(const vector<Live555TestStream>& streams)
+        {
+            _taskScheduler = unique_ptr<BasicTaskScheduler>(BasicTaskScheduler::createNew());
+            _environment = unique_ptr<BasicUsageEnvironment,
+                BasicUsageEnvrionmentDeleter>(BasicUsageEnvironment::createNew(*_taskScheduler));
+
+            // whole frames are handed to the sinks, keyframes can be large
+            OutPacketBuffer::increaseMaxSizeTo(kMaxFrameSize);
+
+            _server = RTSPServer::createNew(*_environment,
+                Port(static_cast<portNumBits>(_port)), nullptr);
+            if (_server == nullptr)
+            {
+                Debug::LogError("Live555TestServer::Start - failed to listen on port %d: %s",
+                    _port, _environment->getResultMsg());
+                return false;
+            }
+
+            for (auto i = 0; i < streams.size(); ++i)
+            {
+                auto& stream = streams[i];
+
+                auto data = ReadFile(stream.Path);
+                if (data.empty())
+                {
+                    Debug::LogError("Live555TestServer::Start - failed to read %s",
+                        stream.Path.c_str());
+                    return false;
+                }
+
+                auto subsession = static_cast<ServerMediaSubsession*>(nullptr);
+
+                switch (stream.Codec)
+                {
+                case LIVE555_TEST_CODEC_H264:
+                    subsession = new H264TestSubsession(*_environment, stream,
+                        make_shared<const vector<uint8_t>>(move(data)));
+                    break;
+                case LIVE555_TEST_CODEC_MJPEG:
+                {
+                    auto clip = make_shared<MJPEGClip>();
+                    clip->Data = move(data);
+                    clip->Frames = ParseMJPEG(clip->Data);
+
+                    if (clip->Frames.empty())
+                    {
+                        Debug::LogError("Live555TestServer::Start - %s has no baseline jpegs",
+                            stream.Path.c_str());
+                        return false;
+                    }
+
+                    subsession = new MJPEGTestSubsession(*_environment, stream, clip);
+                    break;
+                }
+                default:
+                    Debug::LogError("Live555TestServer::Start - unsupported codec");
+                    return false;
+                }
+
+                auto session = ServerMediaSession::createNew(*_environment, stream.Name.c_str(),
+                    stream.Name.c_str(), "UnityAV test stream");
+                session->addSubsession(subsession);
+                _server->addServerMediaSession(session);
+                _names.push_back(stream.Name);
+            }
+
+            _dropClientsTrigger = _taskScheduler->createEventTrigger(OnDropClients);
+            if (_dropClientsTrigger == 0)
+            {
+                Debug::LogError("Live555TestServer::Start - failed to create event trigger");
+                return false;
+            }
+
+            _thread = thread(&Live555TestServer::ThreadMethod, this);
+
+            return true;
+        }
+
+        void Live555TestServer::ThreadMethod()
+        {
+            // enter the event loop
+            _taskScheduler->doEventLoop(&_watchVariable);
+        }
+
+        void Live555TestServer::OnDropClients(void* server)
+        {
+            auto& testServer = *static_cast<Live555TestServer*>(server);
+
+            for (auto i = 0; i < testServer._names.size(); ++i)
+            {
+                testServer._server->closeAllClientSessionsForServerMediaSession(
+                    testServer._names[i].c_str());
+            }
+        }
+    }
+}
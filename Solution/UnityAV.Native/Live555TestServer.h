@@ -0,0 +1,134 @@
+﻿#pragma once
+
+// can't be included as part of stdafx, causes problems in avlib code
+#include <RTSPServer.hh>
+
+#include "Live555Util.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief The codecs the test server can stream files of
+         */
+        enum Live555TestCodec
+        {
+            // an annex b byte stream, such as made by ffmpeg -bsf:v h264_mp4toannexb -f h264
+            LIVE555_TEST_CODEC_H264 = 0,
+            // concatenated baseline jpegs, such as made by ffmpeg -c:v mjpeg -f mjpeg
+            LIVE555_TEST_CODEC_MJPEG,
+        };
+
+        /**
+         * \brief Describes a stream served by the test server and the network it is
+         * served over, the network is only emulated for udp sessions
+         */
+        struct Live555TestStream
+        {
+            /**
+             * \brief Initializes Live555TestStream with a perfect network
+             */
+            Live555TestStream() : Codec(LIVE555_TEST_CODEC_H264), FramesPerSecond(25),
+                MaxKilobitsPerSecond(0), PacketLoss(0), JitterMilliseconds(0)
+            {
+
+            }
+
+            /**
+             * \brief The name of the stream, the last part of its uri
+             */
+            string Name;
+            /**
+             * \brief The path of the file to serve, it loops
+             */
+            string Path;
+            /**
+             * \brief The codec of the file
+             */
+            Live555TestCodec Codec;
+            /**
+             * \brief The frame rate of mjpeg files, h264 files are paced by their sps
+             */
+            int FramesPerSecond;
+            /**
+             * \brief The capacity of the link, packets beyond it are queued and then
+             * dropped, zero is unlimited
+             */
+            int MaxKilobitsPerSecond;
+            /**
+             * \brief The chance of any rtp or rtcp packet being lost, from 0 to 1
+             */
+            double PacketLoss;
+            /**
+             * \brief The most a packet is randomly held back by, packets may be reordered
+             */
+            int JitterMilliseconds;
+        };
+
+        /**
+         * \brief Responsible for serving local files over rtsp in process, so streaming
+         * can be tested and benchmarked without cameras or a network, the server runs
+         * its own live555 event loop on its own thread
+         */
+        class Live555TestServer
+        {
+        public:
+            static const int DefaultPort;
+
+            /**
+             * \brief Deconstructs an instance of Live555TestServer, stopping its event loop
+             * and closing every session
+             */
+            virtual ~Live555TestServer();
+            // Disabled copy constructor
+            explicit Live555TestServer(const Live555TestServer&& other) = delete;
+            // Disabled copy assignment
+            Live555TestServer& operator=(const Live555TestServer&& other) = delete;
+            // Disabled move constructor
+            explicit Live555TestServer(Live555TestServer&& other) = delete;
+            // Disabled move assignment
+            Live555TestServer& operator=(Live555TestServer&& other) = delete;
+
+            /**
+             * \brief Creates a test server and starts serving
+             * \param streams The streams to serve
+             * \param port The port to listen on
+             * \return The test server, nullptr on failure
+             */
+            static unique_ptr<Live555TestServer> Create(const vector<Live555TestStream>& streams,
+                int port = DefaultPort);
+
+            /**
+             * \brief Evaluates the uri of a stream on the loopback interface
+             * \param name The name of the stream
+             * \return The uri of the stream
+             */
+            string Uri(const string& name) const;
+            /**
+             * \brief Closes every client session of every stream, as if the server
+             * restarted, safe to call from any thread
+             */
+            void DropClients();
+
+        private:
+            explicit Live555TestServer(int port);
+
+            bool Start(const vector<Live555TestStream>& streams);
+            void ThreadMethod();
+            static void OnDropClients(void* server);
+
+            // core
+            int _port;
+            vector<string> _names;
+            unique_ptr<BasicTaskScheduler> _taskScheduler;
+            unique_ptr<BasicUsageEnvironment, BasicUsageEnvrionmentDeleter> _environment;
+            RTSPServer* _server;
+            EventTriggerId _dropClientsTrigger;
+
+            // threading
+            thread _thread;
+            volatile char _watchVariable;
+        };
+    }
+}
@@ -1,2 +1,148 @@
 ﻿#include "stdafx.h"
 #include "Live555Util.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        AVCodecID ToAVCodecID(MediaSubsession& subsession)
+        {
+            auto codecName = string(subsession.codecName());
+
+            if (codecName == "H264")
+            {
+                return AV_CODEC_ID_H264;
+            }
+            if (codecName == "H265")
+            {
+                return AV_CODEC_ID_HEVC;
+            }
+            if (codecName == "JPEG")
+            {
+                return AV_CODEC_ID_MJPEG;
+            }
+            if (codecName == "MP4V-ES")
+            {
+                return AV_CODEC_ID_MPEG4;
+            }
+
+            return AV_CODEC_ID_NONE;
+        }
+
+        static void AppendParameterSets(vector<uint8_t>& extradata, const char* parameterSets)
+        {
+            if (parameterSets == nullptr)
+            {
+                return;
+            }
+
+            auto recordCount = 0u;
+            auto records = parseSPropParameterSets(parameterSets, recordCount);
+
+            // each parameter set is given its start code, as the decoder expects annex b
+            for (auto i = 0u; i < recordCount; ++i)
+            {
+                extradata.insert(extradata.end(), begin(kNALStartCode), end(kNALStartCode));
+                extradata.insert(extradata.end(), records[i].sPropBytes,
+                    records[i].sPropBytes + records[i].sPropLength);
+            }
+
+            delete[] records;
+        }
+
+        bool IsNALSubsession(MediaSubsession& subsession)
+        {
+            auto codecId = ToAVCodecID(subsession);
+            return codecId == AV_CODEC_ID_H264 || codecId == AV_CODEC_ID_HEVC;
+        }
+
+        unique_ptr<AVCodecParameters, AVCodecParametersDeleter> CreateCodecParameters(
+            MediaSubsession& subsession)
+        {
+            auto parameters = unique_ptr<AVCodecParameters, AVCodecParametersDeleter>(
+                avcodec_parameters_alloc());
+
+            if (!parameters)
+            {
+                Debug::LogError("CreateCodecParameters - failed to allocate codec parameters");
+                return nullptr;
+            }
+
+            auto mediumName = string(subsession.mediumName());
+
+            if (mediumName == "video")
+            {
+                parameters->codec_type = AVMEDIA_TYPE_VIDEO;
+            }
+            else if (mediumName == "audio")
+            {
+                parameters->codec_type = AVMEDIA_TYPE_AUDIO;
+            }
+            else
+            {
+                // application and text subsessions carry metadata
+                parameters->codec_type = AVMEDIA_TYPE_DATA;
+            }
+
+            parameters->codec_id = ToAVCodecID(subsession);
+
+            if (parameters->codec_id == AV_CODEC_ID_NONE)
+            {
+                Debug::LogWarning("CreateCodecParameters - unsupported codec %s",
+                    subsession.codecName());
+                return parameters;
+            }
+
+            // the sdp may leave the dimensions out, the decoder then finds them in-band
+            parameters->width = subsession.videoWidth();
+            parameters->height = subsession.videoHeight();
+
+            // jpeg headers are rebuilt per frame by live555, the others need extradata
+            auto extradata = vector<uint8_t>();
+
+            switch (parameters->codec_id)
+            {
+            case AV_CODEC_ID_H264:
+                AppendParameterSets(extradata, subsession.fmtp_spropparametersets());
+                break;
+            case AV_CODEC_ID_HEVC:
+                AppendParameterSets(extradata, subsession.fmtp_spropvps());
+                AppendParameterSets(extradata, subsession.fmtp_spropsps());
+                AppendParameterSets(extradata, subsession.fmtp_sproppps());
+                break;
+            case AV_CODEC_ID_MPEG4:
+                if (subsession.fmtp_config() != nullptr)
+                {
+                    auto configSize = 0u;
+                    auto config = parseGeneralConfigStr(subsession.fmtp_config(), configSize);
+
+                    if (config != nullptr)
+                    {
+                        extradata.insert(extradata.end(), config, config + configSize);
+                        delete[] config;
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+
+            if (!extradata.empty())
+            {
+                parameters->extradata = static_cast<uint8_t*>(av_mallocz(
+                    extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+
+                if (parameters->extradata == nullptr)
+                {
+                    Debug::LogError("CreateCodecParameters - failed to allocate extradata");
+                    return nullptr;
+                }
+
+                memcpy(parameters->extradata, extradata.data(), extradata.size());
+                parameters->extradata_size = static_cast<int>(extradata.size());
+            }
+
+            return parameters;
+        }
+    }
+}
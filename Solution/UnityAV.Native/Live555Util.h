@@ -2,6 +2,10 @@
 
 // can't be included as part of stdafx, causes problems in avlib code
 #include <BasicUsageEnvironment.hh>
+#include <liveMedia.hh>
+#include <GroupsockHelper.hh>
+
+#include "AVLibUtil.h"
 
 namespace UnityAV
 {
@@ -17,5 +21,31 @@ namespace UnityAV
                 env->reclaim();
             }
         };
+
+        /**
+         * \brief The annex b start code which live555 strips from each received nal unit
+         */
+        const uint8_t kNALStartCode[] = { 0x00, 0x00, 0x00, 0x01 };
+
+        /**
+         * \brief Evaluates the codec a subsession delivers from its sdp description
+         * \param subsession The subsession to evaluate
+         * \return The codec id, AV_CODEC_ID_NONE when the codec is not supported
+         */
+        AVCodecID ToAVCodecID(MediaSubsession& subsession);
+        /**
+         * \brief Evaluates if a subsession delivers h264 or h265 nal units
+         * \param subsession The subsession to evaluate
+         * \return True if the subsession delivers nal units, false otherwise
+         */
+        bool IsNALSubsession(MediaSubsession& subsession);
+        /**
+         * \brief Creates codec parameters from the sdp description of a subsession
+         * \param subsession The subsession to create the codec parameters for
+         * \return The codec parameters, the codec id is AV_CODEC_ID_NONE when the 
+         * codec is not supported, nullptr on failure
+         */
+        unique_ptr<AVCodecParameters, AVCodecParametersDeleter> CreateCodecParameters(
+            MediaSubsession& subsession);
     }
 }
@@ -1,6 +1,7 @@
 ﻿#include "stdafx.h"
 #include "Player.h"
 #include "AVLibPlayer.h"
+#include "AVLibSharedPlayer.h"
 
 namespace UnityAV
 {
@@ -11,10 +12,31 @@ namespace UnityAV
             
         Player::Player(const string& uri, unique_ptr<IVideoClient> client) : _uri(uri)
         {
-            _videoClient = move(client);         
+            // the first client decides the format decoded to
+            if (client)
+            {
+                _requiredVideo = VideoDescription(*client);
+                _videoClients.push_back(move(client));
+            }
+        }
+
+        unique_ptr<Player> Player::Create(const string& uri, unique_ptr<IVideoClient> client,
+            const PlayerOptions& options)
+        {
+            if (!Exists(uri))
+            {
+                return nullptr;
+            }
+
+            if (options.ShareDecoding)
+            {
+                return AVLibSharedPlayer::Create(uri, move(client), options);
+            }
+
+            return make_unique<AVLibPlayer>(uri, move(client), options);
         }
 
-        unique_ptr<Player> Player::Create(const string& uri, unique_ptr<IVideoClient> client)
+        bool Player::Exists(const string& uri)
         {
             // if we're looking at a file, not an rtsp stream
             if (uri.find(RTSPPrefix) == string::npos)
@@ -23,17 +45,68 @@ namespace UnityAV
 
                 if (!stream.good())
                 {
-                    Debug::LogError("File does not exist at given uri: %s", uri);
-                    return nullptr;
+                    Debug::LogError("File does not exist at given uri: %s", uri.c_str());
+                    return false;
                 }
             }
 
-            return make_unique<AVLibPlayer>(uri, move(client));
+            return true;
+        }
+
+        IVideoClient* Player::AddClient(unique_ptr<IVideoClient> client)
+        {
+            if (!client)
+            {
+                return nullptr;
+            }
+
+            if (!IVideoDescription::Compatible(*client, _requiredVideo))
+            {
+                client = AdaptClient(move(client));
+            }
+
+            lock_guard<mutex> lock(_clientsMutex);
+            _videoClients.push_back(move(client));
+
+            return _videoClients.back().get();
+        }
+
+        void Player::RemoveClient(IVideoClient* client)
+        {
+            lock_guard<mutex> lock(_clientsMutex);
+
+            for (auto it = _videoClients.begin(); it != _videoClients.end(); ++it)
+            {
+                if (it->get() == client)
+                {
+                    _videoClients.erase(it);
+                    return;
+                }
+            }
         }
 
         void Player::Write()
         {
-            _videoClient->Write();
+            lock_guard<mutex> lock(_clientsMutex);
+
+            for (auto i = 0; i < _videoClients.size(); ++i)
+            {
+                _videoClients[i]->Write();
+            }
+        }
+
+        void Player::Write(IVideoClient* client)
+        {
+            lock_guard<mutex> lock(_clientsMutex);
+
+            for (auto i = 0; i < _videoClients.size(); ++i)
+            {
+                if (_videoClients[i].get() == client)
+                {
+                    client->Write();
+                    return;
+                }
+            }
         }
 
         void Player::Visit(VideoFrame& frame)
@@ -47,14 +120,45 @@ namespace UnityAV
             frame.Accept(*this);
         }
 
+        unique_ptr<IVideoClient> Player::AdaptClient(unique_ptr<IVideoClient> client) const
+        {
+            return client;
+        }
+
         const IVideoDescription& Player::RequiredVideoFrame() const
         {
-            return *_videoClient;
+            return _requiredVideo;
+        }
+
+        vector<VideoDescription> Player::RequiredVideoFrames() const
+        {
+            auto result = vector<VideoDescription>();
+            result.push_back(_requiredVideo);
+
+            lock_guard<mutex> lock(_clientsMutex);
+            for (auto i = 0; i < _videoClients.size(); ++i)
+            {
+                result.push_back(VideoDescription(*_videoClients[i]));
+            }
+
+            return result;
         }
 
         void Player::OnDisplayVideoFrame(VideoFrame& frame)
         {
-            _videoClient->OnFrameReady(frame);
+            // clients may scale the frame, which mustn't hold up writing or changing
+            // the clients, a removed client lives on until its frame is handed over
+            auto clients = vector<shared_ptr<IVideoClient>>();
+            {
+                lock_guard<mutex> lock(_clientsMutex);
+                clients = _videoClients;
+            }
+
+            // every client reads the output of the frame matching it, if any
+            for (auto i = 0; i < clients.size(); ++i)
+            {
+                clients[i]->OnFrameReady(frame.OutputFor(*clients[i]));
+            }
         }
     }
 }
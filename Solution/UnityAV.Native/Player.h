@@ -1,5 +1,8 @@
 ﻿#pragma once
 #include "IVideoClient.h"
+#include "VideoDescription.h"
+#include "PlayerOptions.h"
+#include "PlayerStatistics.h"
 
 using namespace std;
 
@@ -29,9 +32,12 @@ namespace UnityAV
             /**
              * \brief Creates a player instance
              * \param uri The uri to evaluate for creating the instance
+             * \param client The video client
+             * \param options The options to create the player with
              * \return The player instance or a nullptr on failure
              */
-            static unique_ptr<Player> Create(const string& uri, unique_ptr<IVideoClient> client);
+            static unique_ptr<Player> Create(const string& uri, unique_ptr<IVideoClient> client,
+                const PlayerOptions& options = PlayerOptions());
 
             /**
             * \brief Starts or resumes playback of the media
@@ -85,10 +91,85 @@ namespace UnityAV
              * \return True if the player is realtime, false otherwise
              */
             virtual bool IsRealtime() const = 0;
+            /**
+             * \brief Queues media to be played once the current media has finished,
+             * the next queued media is opened and prepared while the current plays
+             * \param uri The uri of the media to queue
+             * \return True if the media was queued, false otherwise
+             */
+            virtual bool Enqueue(const string& uri) = 0;
+            /**
+             * \brief Evaluates the runtime statistics of the player
+             * \return The runtime statistics of the player
+             */
+            virtual PlayerStatistics Statistics() const = 0;
+            /**
+             * \brief Adds an alternative profile of the media at another uri, such as a
+             * camera's low resolution sub-stream
+             * \param uri The uri of the profile
+             * \param width The width of the profile's video in pixels
+             * \param height The height of the profile's video in pixels
+             * \return True if the profile was added, false otherwise
+             */
+            virtual bool AddStreamProfile(const string& uri, int width, int height) = 0;
+            /**
+             * \brief Sets the size the media is displayed at, live media then switches
+             * to the smallest profile covering it without a gap in playback
+             * \param width The displayed width in pixels
+             * \param height The displayed height in pixels
+             */
+            virtual void SetDisplaySize(int width, int height) = 0;
+            /**
+             * \brief Limits how many frames a second the media is decoded and shown at,
+             * frames over the limit are skipped before decoding where they can be and
+             * are otherwise never converted
+             * \param framesPerSecond The most frames a second, zero is unlimited
+             */
+            virtual void SetMaxFrameRate(double framesPerSecond) = 0;
+            /**
+             * \brief Starts recording the media's compressed streams to a file without
+             * decoding them, replacing any recording in progress, live media is recorded
+             * once connected
+             * \param path The path of the file, .mp4 or .mkv
+             * \return True if recording started or will start once connected
+             */
+            virtual bool StartRecording(const string& path) = 0;
+            /**
+             * \brief Stops recording and finishes the file
+             */
+            virtual void StopRecording() = 0;
+            /**
+             * \brief Saves a clip of the media's compressed streams around now, written
+             * without blocking as the rest of the clip arrives
+             * \param secondsBefore The seconds before now the clip begins, limited to the
+             * packets kept for clips
+             * \param secondsAfter The seconds after now the clip ends
+             * \param path The path of the file, .mp4 or .mkv
+             * \return True if the clip was started, false otherwise
+             */
+            virtual bool SaveClip(double secondsBefore, double secondsAfter,
+                const string& path) = 0;
+            /**
+             * \brief Adds a client which receives the same frames as all other clients,
+             * clients of a different size or format have the frames converted
+             * \param client The client to add
+             * \return A handle to the added client, nullptr on failure
+             */
+            IVideoClient* AddClient(unique_ptr<IVideoClient> client);
+            /**
+             * \brief Removes a client from the player
+             * \param client The handle of the client to remove
+             */
+            void RemoveClient(IVideoClient* client);
             /**
              * \brief Writes the playing media to all clients 
              */
-            void Write();
+            virtual void Write();
+            /**
+             * \brief Writes the playing media to a single client
+             * \param client The handle of the client to write
+             */
+            void Write(IVideoClient* client);
 
             void Visit(VideoFrame& frame) override;
 
@@ -103,6 +184,20 @@ namespace UnityAV
              */
             explicit Player(const string& uri, unique_ptr<IVideoClient> client);
 
+            /**
+             * \brief Adapts a client which doesn't match the required video format
+             * \param client The client to adapt
+             * \return The adapted client
+             */
+            virtual unique_ptr<IVideoClient> AdaptClient(unique_ptr<IVideoClient> client) const;
+
+            /**
+             * \brief Evaluates if a uri points to media that can be opened
+             * \param uri The uri to evaluate
+             * \return True if the uri can be opened, false otherwise
+             */
+            static bool Exists(const string& uri);
+
             /**
              * \brief Called by concrete players when a frame is ready
              * \param frame The frame that is ready
@@ -113,11 +208,19 @@ namespace UnityAV
              * \return Returns the required video format
              */
             const IVideoDescription& RequiredVideoFrame() const;
+            /**
+             * \brief Evaluates the video formats of every client, starting with the 
+             * required video format
+             * \return Returns the video formats of every client
+             */
+            vector<VideoDescription> RequiredVideoFrames() const;
 
         private:
             void OnDisplayVideoFrame(VideoFrame& frame);
 
-            unique_ptr<IVideoClient> _videoClient;
+            vector<shared_ptr<IVideoClient>> _videoClients;
+            mutable mutex _clientsMutex;
+            VideoDescription _requiredVideo;
             string _uri;
         };
     }
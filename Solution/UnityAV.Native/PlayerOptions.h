@@ -0,0 +1,136 @@
+﻿#pragma once
+#include "RTSPTransport.h"
+#include "RTSPBackend.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief The options a player is created with, laid out to be passed across
+         * the native plugin boundary
+         */
+        struct PlayerOptions
+        {
+            /**
+             * \brief Initializes PlayerOptions with the default values
+             */
+            PlayerOptions() : CacheInMemory(false), CacheDecodedFrames(false),
+                FrameCacheMegabytes(320), ShareDecoding(false), SharedTimeline(true),
+                LowLatency(false), JitterBufferFactor(3.0f),
+                Transport(RTSP_TRANSPORT_UDP), ReceiveBufferKilobytes(2048), 
+                RequestKeyframes(true), ReceiveAudio(false), ReceiveData(false),
+                TimeShiftSeconds(0), TimeShiftMegabytes(256), TimeShiftSpillMegabytes(0),
+                CatchUpSpeed(1.5f), ClipBufferSeconds(0), ClipBufferMegabytes(64),
+                Backend(RTSP_BACKEND_LIVE555), IntraDecoders(0), AdaptiveQuality(false)
+            {
+
+            }
+
+            /**
+             * \brief Loads file media into memory once and shares it with every player
+             * of the same uri, looping and seeking then cost no disk io
+             */
+            bool CacheInMemory;
+            /**
+             * \brief Keeps every decoded video frame of the first pass in memory, later
+             * loops are then served without demuxing or decoding, suited to short clips
+             */
+            bool CacheDecodedFrames;
+            /**
+             * \brief The memory budget of the decoded frame cache, caching is abandoned
+             * if the clip does not fit
+             */
+            int FrameCacheMegabytes;
+            /**
+             * \brief Shares the source and decoders with every other sharing player of
+             * the same uri, the options of the first player are used by all of them
+             */
+            bool ShareDecoding;
+            /**
+             * \brief Whether sharing players of a file also share play, stop and seek,
+             * without it each player decodes itself but still shares an in-memory copy of
+             * the file, live streams always share their timeline
+             */
+            bool SharedTimeline;
+            /**
+             * \brief Trades smoothness for latency on live streams, queues are kept
+             * shallow, the newest frame is always presented and frames are written as
+             * soon as they are decoded
+             */
+            bool LowLatency;
+            /**
+             * \brief How many multiples of the measured network jitter live frames are
+             * held back by, zero favours latency and larger values favour smoothness
+             */
+            float JitterBufferFactor;
+            /**
+             * \brief How rtp is carried for rtsp sessions
+             */
+            RTSPTransport Transport;
+            /**
+             * \brief The receive buffer size requested for udp rtp sockets, a larger 
+             * buffer rides out bursts of large frames without losing packets
+             */
+            int ReceiveBufferKilobytes;
+            /**
+             * \brief Whether live streams ask the server for a keyframe when joining or
+             * after losing data, rather than waiting for the next one
+             */
+            bool RequestKeyframes;
+            /**
+             * \brief Whether the audio subsessions of rtsp sessions are set up and
+             * exposed as streams, otherwise they are never received
+             */
+            bool ReceiveAudio;
+            /**
+             * \brief Whether the metadata and other non audio-visual subsessions of rtsp
+             * sessions are set up and exposed as streams
+             */
+            bool ReceiveData;
+            /**
+             * \brief How many seconds of a live stream are kept so it can be paused and
+             * rewound, zero disables time shifting
+             */
+            int TimeShiftSeconds;
+            /**
+             * \brief The memory budget of the compressed packets kept for time shifting
+             */
+            int TimeShiftMegabytes;
+            /**
+             * \brief How many megabytes of packets beyond the memory budget spill into a
+             * temporary file, zero keeps the time shift window in memory only
+             */
+            int TimeShiftSpillMegabytes;
+            /**
+             * \brief The speed time shifted playback runs at, faster than one catches
+             * back up with the live stream
+             */
+            float CatchUpSpeed;
+            /**
+             * \brief How many seconds of packets are kept so saved clips can begin before
+             * they were asked for, zero keeps none
+             */
+            int ClipBufferSeconds;
+            /**
+             * \brief The memory budget of the packets kept for clips
+             */
+            int ClipBufferMegabytes;
+            /**
+             * \brief Which implementation receives rtsp sessions, libavformat's supports
+             * none of profiles, time shifting or keyframe requests
+             */
+            RTSPBackend Backend;
+            /**
+             * \brief How many codec contexts decode intra only streams such as mjpeg in
+             * parallel, zero picks one from the cores available, one decodes serially
+             */
+            int IntraDecoders;
+            /**
+             * \brief Whether decoding trades quality for speed when playback falls
+             * behind, skipping filtering, then frames, and returning once it catches up
+             */
+            bool AdaptiveQuality;
+        };
+    }
+}
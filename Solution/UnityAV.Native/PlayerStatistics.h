@@ -0,0 +1,88 @@
+﻿#pragma once
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief The runtime statistics of a player, laid out to be passed across the
+         * native plugin boundary
+         */
+        struct PlayerStatistics
+        {
+            /**
+             * \brief Initializes PlayerStatistics with all counters zeroed
+             */
+            PlayerStatistics() : CacheHits(0), CacheMisses(0), CachedBytes(0), 
+                CachedFrames(0), JitterBufferDepth(0), LateFrames(0), JitterMilliseconds(0),
+                JitterBufferDelayMilliseconds(0), PacketsReceived(0), PacketsLost(0),
+                TruncatedFrames(0), FramesAwaitingKeyframe(0), KeyframeRequests(0),
+                QualityChanges(0), QualityLevel(0)
+            {
+
+            }
+
+            /**
+             * \brief The number of frames served from the decoded frame cache
+             */
+            int64_t CacheHits;
+            /**
+             * \brief The number of frames that had to be decoded while caching was enabled
+             */
+            int64_t CacheMisses;
+            /**
+             * \brief The size of the decoded frame cache in bytes
+             */
+            int64_t CachedBytes;
+            /**
+             * \brief The number of frames held in the decoded frame cache
+             */
+            int CachedFrames;
+            /**
+             * \brief The number of live frames waiting in the jitter buffer
+             */
+            int JitterBufferDepth;
+            /**
+             * \brief The number of live frames dropped for arriving too late to be shown
+             */
+            int64_t LateFrames;
+            /**
+             * \brief The measured interarrival jitter of live frames in milliseconds
+             */
+            double JitterMilliseconds;
+            /**
+             * \brief The delay live frames are currently held back by in milliseconds
+             */
+            double JitterBufferDelayMilliseconds;
+            /**
+             * \brief The number of rtp packets received by live streams
+             */
+            int64_t PacketsReceived;
+            /**
+             * \brief The number of rtp packets live streams expected but never received
+             */
+            int64_t PacketsLost;
+            /**
+             * \brief The number of live frames dropped for not fitting the receive buffer
+             */
+            int64_t TruncatedFrames;
+            /**
+             * \brief The number of live frames dropped while waiting for a keyframe after
+             * joining or losing data
+             */
+            int64_t FramesAwaitingKeyframe;
+            /**
+             * \brief The number of times live streams asked the server for a keyframe
+             */
+            int64_t KeyframeRequests;
+            /**
+             * \brief The number of times decoding stepped its quality down or up
+             */
+            int64_t QualityChanges;
+            /**
+             * \brief How far decoding has degraded to keep up, zero is full quality
+             */
+            int QualityLevel;
+        };
+    }
+}
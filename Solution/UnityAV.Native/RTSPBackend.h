@@ -0,0 +1,10 @@
+﻿#pragma once
+
+/**
+* \brief Represents which implementation receives rtsp sessions
+*/
+enum RTSPBackend
+{
+    RTSP_BACKEND_LIVE555 = 0,
+    RTSP_BACKEND_AVFORMAT
+};
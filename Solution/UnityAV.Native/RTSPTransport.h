@@ -0,0 +1,11 @@
+﻿#pragma once
+
+/**
+* \brief Represents how rtp is carried for a rtsp session
+*/
+enum RTSPTransport
+{
+    RTSP_TRANSPORT_UDP = 0,
+    RTSP_TRANSPORT_TCP,
+    RTSP_TRANSPORT_MULTICAST
+};
@@ -65,6 +65,7 @@ namespace Rendering
         // check state
         if ((force || Changed.load()) && Ready.load())
         {
+            lock_guard<mutex> lock(BufferMutex);
             _device->GetImmediateContext(&_context);
 
             // update the texture from our swap buffer
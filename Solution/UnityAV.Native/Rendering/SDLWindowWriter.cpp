@@ -33,6 +33,7 @@ namespace Rendering
         // check changed state
         if (force || Changed.load())
         {
+            lock_guard<mutex> lock(BufferMutex);
             auto surface = _window.Surface();
 
             SDL_RenderClear(_window.Renderer());
@@ -23,6 +23,9 @@ namespace Rendering
             return;
         }
 
+        // frames arrive on the decode thread while the render thread writes
+        lock_guard<mutex> lock(BufferMutex);
+
         for(auto i = 0; i < BufferCount(); ++i)
         {
             if(!source[i])
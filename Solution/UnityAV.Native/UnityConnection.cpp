@@ -7,6 +7,12 @@ unique_ptr<vector<unique_ptr<Player>>> gPlayers(nullptr);
 
 extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
     GetPlayer(const char * path, void * targetTexture)
+{
+    return GetPlayerWithOptions(path, targetTexture, nullptr);
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    GetPlayerWithOptions(const char * path, void * targetTexture, const PlayerOptions * options)
 {
     auto result = -1;
 
@@ -30,7 +36,8 @@ extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
     // create the connector between the writer and the player
     auto connector = make_unique<TextureClient>(move(writer));
     // create the player, taking the connector    
-    auto player = Player::Create(string(path), move(connector));
+    auto player = Player::Create(string(path), move(connector), 
+        options ? *options : PlayerOptions());
 
     // add the player to the cache of players
     gPlayers->push_back(move(player));
@@ -155,6 +162,126 @@ extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
     return result;
 }
 
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    Enqueue(int id, const char * path)
+{
+    auto result = -1;
+
+    if (path && ValidatePlayerId(id))
+    {
+        if ((*gPlayers)[id]->Enqueue(string(path)))
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    GetStatistics(int id, PlayerStatistics * statistics)
+{
+    auto result = -1;
+
+    if (statistics && ValidatePlayerId(id))
+    {
+        *statistics = (*gPlayers)[id]->Statistics();
+        result = 0;
+    }
+
+    return result;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    AddStreamProfile(int id, const char * path, int width, int height)
+{
+    auto result = -1;
+
+    if (path && ValidatePlayerId(id))
+    {
+        if ((*gPlayers)[id]->AddStreamProfile(string(path), width, height))
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    SetDisplaySize(int id, int width, int height)
+{
+    auto result = -1;
+
+    if (ValidatePlayerId(id))
+    {
+        (*gPlayers)[id]->SetDisplaySize(width, height);
+        result = 0;
+    }
+
+    return result;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    SetMaxFrameRate(int id, double framesPerSecond)
+{
+    auto result = -1;
+
+    if (framesPerSecond >= 0 && ValidatePlayerId(id))
+    {
+        (*gPlayers)[id]->SetMaxFrameRate(framesPerSecond);
+        result = 0;
+    }
+
+    return result;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    StartRecording(int id, const char * path)
+{
+    auto result = -1;
+
+    if (path && ValidatePlayerId(id))
+    {
+        if ((*gPlayers)[id]->StartRecording(string(path)))
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    StopRecording(int id)
+{
+    auto result = -1;
+
+    if (ValidatePlayerId(id))
+    {
+        (*gPlayers)[id]->StopRecording();
+        result = 0;
+    }
+
+    return result;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    SaveClip(int id, double secondsBefore, double secondsAfter, const char * path)
+{
+    auto result = -1;
+
+    if (path && ValidatePlayerId(id))
+    {
+        if ((*gPlayers)[id]->SaveClip(secondsBefore, secondsAfter, string(path)))
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
 bool ValidatePlayerId(int id)
 {
     if (id < 0)
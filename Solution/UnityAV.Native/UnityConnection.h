@@ -29,6 +29,16 @@ extern "C" void ForcePlayersWrite();
 extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
     GetPlayer(const char * path, void * targetTexture);
 
+/**
+* \brief Gets a media player created with the given options
+* \param path The uri of the media to play
+* \param targetTexture The raw pointer to a target texture
+* \param options The options to create the player with, defaults are used if null
+* \return Returns Non-negative unique id of the player, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    GetPlayerWithOptions(const char * path, void * targetTexture, const PlayerOptions * options);
+
 /**
 * \brief Releases a media player
 * \param id The unique id of the player to release
@@ -95,6 +105,82 @@ extern "C" double UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
 extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
     SetLoop(int id, bool loop);
 
+/**
+* \brief Queues media to be played by a media player once its current media has finished
+* \param id The player id to queue the media for
+* \param path The uri of the media to queue
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    Enqueue(int id, const char * path);
+
+/**
+* \brief Evaluates the runtime statistics of a media player
+* \param id The player id to evaluate
+* \param statistics The statistics to fill
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    GetStatistics(int id, PlayerStatistics * statistics);
+
+/**
+* \brief Adds an alternative profile of a media player's stream, such as a sub-stream
+* \param id The player id to add the profile for
+* \param path The uri of the profile
+* \param width The width of the profile's video in pixels
+* \param height The height of the profile's video in pixels
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    AddStreamProfile(int id, const char * path, int width, int height);
+
+/**
+* \brief Sets the size a media player is displayed at, picking the profile streamed
+* \param id The player id to set the display size for
+* \param width The displayed width in pixels
+* \param height The displayed height in pixels
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    SetDisplaySize(int id, int width, int height);
+
+/**
+* \brief Limits how many frames a second a media player decodes and shows
+* \param id The player id to limit
+* \param framesPerSecond The most frames a second, zero is unlimited
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    SetMaxFrameRate(int id, double framesPerSecond);
+
+/**
+* \brief Starts recording a media player's streams to a file without decoding them
+* \param id The player id to record
+* \param path The path of the file to record to, .mp4 or .mkv
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    StartRecording(int id, const char * path);
+
+/**
+* \brief Stops recording a media player's streams and finishes the file
+* \param id The player id to stop recording
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    StopRecording(int id);
+
+/**
+* \brief Saves a clip of a media player's streams around now without decoding them
+* \param id The player id to save the clip of
+* \param secondsBefore The seconds before now the clip begins
+* \param secondsAfter The seconds after now the clip ends
+* \param path The path of the file to save to, .mp4 or .mkv
+* \return Returns Non-negative value on success, negative on failure
+*/
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+    SaveClip(int id, double secondsBefore, double secondsAfter, const char * path);
+
 /**
  * \brief Validates the media players unique id
  * \param id The unique id to validate
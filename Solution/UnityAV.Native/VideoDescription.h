@@ -0,0 +1,65 @@
+﻿#pragma once
+#include "IVideoDescription.h"
+
+namespace UnityAV
+{
+    namespace Media
+    {
+        /**
+         * \brief A plain copy of a video description
+         */
+        class VideoDescription : public IVideoDescription
+        {
+        public:
+            /**
+             * \brief Initializes an empty VideoDescription
+             */
+            explicit VideoDescription() 
+                : _format(PIXEL_FORMAT_NONE), _width(0), _height(0)
+            {
+                
+            }
+            /**
+             * \brief Initializes a new VideoDescription as a copy of another description
+             * \param other The description to copy
+             */
+            explicit VideoDescription(const IVideoDescription& other)
+                : _format(other.Format()), _width(other.Width()), _height(other.Height())
+            {
+
+            }
+            /**
+             * \brief Initializes a new VideoDescription
+             * \param format The pixel format of the video
+             * \param width The width of the video in pixels
+             * \param height The height of the video in pixels
+             */
+            explicit VideoDescription(PixelFormat format, int width, int height)
+                : _format(format), _width(width), _height(height)
+            {
+
+            }
+            // Default destructor
+            virtual ~VideoDescription() {}
+
+            PixelFormat Format() const override
+            {
+                return _format;
+            }
+
+            int Width() const override
+            {
+                return _width;
+            }
+
+            int Height() const override
+            {
+                return _height;
+            }
+
+        private:
+            PixelFormat _format;
+            int _width, _height;
+        };
+    }
+}
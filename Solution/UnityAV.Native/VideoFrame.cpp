@@ -46,7 +46,8 @@ namespace UnityAV
             _sizes(move(other._sizes)),
             _strides(move(other._strides)),
             _buffers(move(other._buffers)), 
-            _base(move(other._base))
+            _base(move(other._base)),
+            _outputs(move(other._outputs))
         {
 #if _DEBUG
             ++MoveConstructed;
@@ -65,6 +66,7 @@ namespace UnityAV
             _strides = move(other._strides);
             _buffers = move(other._buffers);
             _base = move(other._base);
+            _outputs = move(other._outputs);
 #if _DEBUG
             ++MoveAssigned;
 #endif
@@ -126,6 +128,71 @@ namespace UnityAV
             return static_cast<uint8_t* const*>(_base.get());
         }
 
+        int VideoFrame::TotalSize() const
+        {
+            auto result = 0;
+
+            for (auto i = 0; i < BufferCount(); ++i)
+            {
+                result += _sizes[i];
+            }
+
+            for (auto i = 0; i < OutputCount(); ++i)
+            {
+                result += _outputs[i]->TotalSize();
+            }
+
+            return result;
+        }
+
+        void VideoFrame::CopyFrom(const VideoFrame& other)
+        {
+            _time = other._time;
+
+            for (auto i = 0; i < BufferCount() && i < other.BufferCount(); ++i)
+            {
+                memcpy(_buffers[i].get(), other._buffers[i].get(), min(_sizes[i], other._sizes[i]));
+            }
+
+            for (auto i = 0; i < OutputCount() && i < other.OutputCount(); ++i)
+            {
+                _outputs[i]->CopyFrom(*other._outputs[i]);
+            }
+        }
+
+        void VideoFrame::AttachOutput(unique_ptr<VideoFrame> output)
+        {
+            _outputs.push_back(move(output));
+        }
+
+        int VideoFrame::OutputCount() const
+        {
+            return static_cast<int>(_outputs.size());
+        }
+
+        VideoFrame& VideoFrame::Output(int index)
+        {
+            return *_outputs[index];
+        }
+
+        VideoFrame& VideoFrame::OutputFor(IVideoDescription& description)
+        {
+            if (Compatible(*this, description))
+            {
+                return *this;
+            }
+
+            for (auto i = 0; i < OutputCount(); ++i)
+            {
+                if (Compatible(*_outputs[i], description))
+                {
+                    return *_outputs[i];
+                }
+            }
+
+            return *this;
+        }
+
         void VideoFrame::Accept(IFrameVisitor& visitor)
         {
             visitor.Visit(*this);
@@ -72,6 +72,40 @@ namespace UnityAV
              * \return The buffers
              */
             uint8_t* const* Buffers();
+            /**
+             * \brief Evaluates the combined size of all buffers
+             * \return The combined size of all buffers in bytes
+             */
+            int TotalSize() const;
+            /**
+             * \brief Copies the time and buffers of another VideoFrame of identical
+             * dimensions and format
+             * \param other The VideoFrame to copy from
+             */
+            void CopyFrom(const VideoFrame& other);
+            /**
+             * \brief Attaches an alternate output of the same picture in another size or
+             * format, attached outputs travel and are recycled with the frame
+             * \param output The output to attach
+             */
+            void AttachOutput(unique_ptr<VideoFrame> output);
+            /**
+             * \brief Evaluates the number of attached outputs
+             * \return The number of attached outputs
+             */
+            int OutputCount() const;
+            /**
+             * \brief Gets an attached output
+             * \param index The index of the output
+             * \return The attached output
+             */
+            VideoFrame& Output(int index);
+            /**
+             * \brief Finds the frame or attached output matching a description
+             * \param description The description to match
+             * \return The matching output, or the frame itself if none match
+             */
+            VideoFrame& OutputFor(IVideoDescription& description);
 
 #if _DEBUG
             static atomic_int DefaultConstructed;
@@ -99,6 +133,9 @@ namespace UnityAV
             vector<int> _strides;
             vector<unique_ptr<uint8_t>> _buffers;
             unique_ptr<uint8_t*> _base;
+
+            // alternate outputs
+            vector<unique_ptr<VideoFrame>> _outputs;
         };
     }
 }
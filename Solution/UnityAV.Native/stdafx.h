@@ -12,6 +12,9 @@
 #include <mutex>
 #include <fstream>
 #include <unordered_map>
+#include <algorithm>
+#include <future>
+#include <functional>
 #include <ctime>
 
 #include <stdarg.h>
@@ -26,6 +29,7 @@ extern "C" {
 #include <libavutil/avutil.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
+#include <libavutil/random_seed.h>
 #include <libavformat/avformat.h>
 #include <libswscale/swscale.h>
 
@@ -15,6 +15,12 @@ namespace UnityAV
         private const int DefaultWidth = 1024;
         private const int DefaultHeight = 1024;
         private const int InvalidPlayerId = -1;
+        private const int DefaultFrameCacheMegabytes = 320;
+        private const float DefaultJitterBufferFactor = 3.0f;
+        private const int DefaultReceiveBufferKilobytes = 2048;
+        private const int DefaultTimeShiftMegabytes = 256;
+        private const float DefaultCatchUpSpeed = 1.5f;
+        private const int DefaultClipBufferMegabytes = 64;
 
         /// <summary>
         /// The uri of the media to stream
@@ -32,6 +38,132 @@ namespace UnityAV
         /// </summary>
         public bool AutoPlay;
 
+        /// <summary>
+        /// Should the media be loaded into memory once and shared with other players?
+        /// Best suited to short looping files
+        /// </summary>
+        public bool CacheInMemory;
+
+        /// <summary>
+        /// Should decoded frames be kept in memory so later loops skip decoding?
+        /// Best suited to very short looping clips
+        /// </summary>
+        public bool CacheDecodedFrames;
+
+        /// <summary>
+        /// The memory budget for decoded frames in megabytes
+        /// </summary>
+        [Range(1, 4096)]
+        public int FrameCacheMegabytes = DefaultFrameCacheMegabytes;
+
+        /// <summary>
+        /// Should decoding be shared with other players of the same media?
+        /// </summary>
+        public bool ShareDecoding;
+
+        /// <summary>
+        /// Should players sharing decoding also share playback, files which don't are 
+        /// decoded separately from a shared in-memory copy
+        /// </summary>
+        public bool SharedTimeline = true;
+
+        /// <summary>
+        /// Should live streams favour latency over smoothness, always showing the 
+        /// newest frame as soon as it is decoded?
+        /// </summary>
+        public bool LowLatency;
+
+        /// <summary>
+        /// How many multiples of the measured network jitter live frames are held back 
+        /// by, lower favours latency and higher favours smoothness
+        /// </summary>
+        [Range(0, 10)]
+        public float JitterBufferFactor = DefaultJitterBufferFactor;
+
+        /// <summary>
+        /// How rtp is carried for rtsp streams, tcp avoids losses on congested networks
+        /// </summary>
+        public RTSPTransport Transport = RTSPTransport.Udp;
+
+        /// <summary>
+        /// Which implementation receives rtsp streams, some cameras work better with one
+        /// </summary>
+        public RTSPBackend Backend = RTSPBackend.Live555;
+
+        /// <summary>
+        /// The receive buffer size requested for udp rtp sockets in kilobytes
+        /// </summary>
+        [Range(64, 65536)]
+        public int ReceiveBufferKilobytes = DefaultReceiveBufferKilobytes;
+
+        /// <summary>
+        /// Should live streams ask the server for a keyframe when joining or after loss,
+        /// rather than waiting for the next one?
+        /// </summary>
+        public bool RequestKeyframes = true;
+
+        /// <summary>
+        /// Should the audio of rtsp streams be received, it is skipped at setup otherwise
+        /// </summary>
+        public bool ReceiveAudio;
+
+        /// <summary>
+        /// Should the metadata of rtsp streams be received, it is skipped at setup otherwise
+        /// </summary>
+        public bool ReceiveData;
+
+        /// <summary>
+        /// How many seconds of a live stream are kept so it can be paused and rewound,
+        /// zero disables time shifting
+        /// </summary>
+        [Range(0, 3600)]
+        public int TimeShiftSeconds;
+
+        /// <summary>
+        /// The memory budget of the time shift window in megabytes
+        /// </summary>
+        [Range(16, 4096)]
+        public int TimeShiftMegabytes = DefaultTimeShiftMegabytes;
+
+        /// <summary>
+        /// The megabytes of the time shift window which may spill into a temporary file
+        /// once the memory budget is used
+        /// </summary>
+        [Range(0, 65536)]
+        public int TimeShiftSpillMegabytes;
+
+        /// <summary>
+        /// The speed time shifted playback runs at until it catches up with the live stream
+        /// </summary>
+        [Range(1.0f, 4.0f)]
+        public float CatchUpSpeed = DefaultCatchUpSpeed;
+
+        /// <summary>
+        /// How many seconds of packets are kept so saved clips can begin before they were
+        /// asked for, zero keeps none
+        /// </summary>
+        [Range(0, 300)]
+        public int ClipBufferSeconds;
+
+        /// <summary>
+        /// The memory budget of the packets kept for clips in megabytes
+        /// </summary>
+        [Range(8, 1024)]
+        public int ClipBufferMegabytes = DefaultClipBufferMegabytes;
+
+        /// <summary>
+        /// How many decoders share intra only streams such as mjpeg, zero picks one from
+        /// the cores available and one decodes serially
+        /// </summary>
+        [Range(0, 16)]
+        public int IntraDecoders;
+
+        /// <summary>
+        /// Should decoding trade quality for speed when playback falls behind, recovering
+        /// once it catches up?
+        /// </summary>
+        public bool AdaptiveQuality;
+
         /// <summary>
         /// The width of the texture in pixels
         /// </summary>
@@ -62,6 +194,17 @@ namespace UnityAV
         [DllImport("UnityAV.Native")]
         private static extern int GetPlayer(string uri, IntPtr texturePointer);
 
+        /// <summary>
+        /// Gets a media player created with the given options
+        /// </summary>
+        /// <param name="uri">The uri to the media to play</param>
+        /// <param name="texturePointer">The texture pointer to stream to</param>
+        /// <param name="options">The options to create the player with</param>
+        /// <returns>Non-negative unique id of the player, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int GetPlayerWithOptions(string uri, IntPtr texturePointer, 
+            ref PlayerOptions options);
+
         /// <summary>
         /// Releases a media player
         /// </summary>
@@ -121,6 +264,83 @@ namespace UnityAV
         [DllImport("UnityAV.Native")]
         private static extern int SetLoop(int id, bool loop);
 
+        /// <summary>
+        /// Queues media to be played once the current media has finished
+        /// </summary>
+        /// <param name="id">The player id to queue the media for</param>
+        /// <param name="uri">The uri to the media to queue</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int Enqueue(int id, string uri);
+
+        /// <summary>
+        /// Evaluates the runtime statistics of a media player
+        /// </summary>
+        /// <param name="id">The player id to evaluate</param>
+        /// <param name="statistics">The statistics to fill</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int GetStatistics(int id, out PlayerStatistics statistics);
+
+        /// <summary>
+        /// Adds an alternative profile of a media player's stream, such as a sub-stream
+        /// </summary>
+        /// <param name="id">The player id to add the profile for</param>
+        /// <param name="uri">The uri of the profile</param>
+        /// <param name="width">The width of the profile's video in pixels</param>
+        /// <param name="height">The height of the profile's video in pixels</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int AddStreamProfile(int id, string uri, int width, int height);
+
+        /// <summary>
+        /// Sets the size a media player is displayed at
+        /// </summary>
+        /// <param name="id">The player id to set the display size for</param>
+        /// <param name="width">The displayed width in pixels</param>
+        /// <param name="height">The displayed height in pixels</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int SetDisplaySize(int id, int width, int height);
+
+        /// <summary>
+        /// Limits how many frames a second a media player decodes and shows
+        /// </summary>
+        /// <param name="id">The player id to limit</param>
+        /// <param name="framesPerSecond">The most frames a second, zero is unlimited</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int SetMaxFrameRate(int id, double framesPerSecond);
+
+        /// <summary>
+        /// Starts recording a media player's streams to a file without decoding them
+        /// </summary>
+        /// <param name="id">The player id to record</param>
+        /// <param name="path">The path of the file to record to, .mp4 or .mkv</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int StartRecording(int id, string path);
+
+        /// <summary>
+        /// Stops recording a media player's streams and finishes the file
+        /// </summary>
+        /// <param name="id">The player id to stop recording</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int StopRecording(int id);
+
+        /// <summary>
+        /// Saves a clip of a media player's streams around now without decoding them
+        /// </summary>
+        /// <param name="id">The player id to save the clip of</param>
+        /// <param name="secondsBefore">The seconds before now the clip begins</param>
+        /// <param name="secondsAfter">The seconds after now the clip ends</param>
+        /// <param name="path">The path of the file to save to, .mp4 or .mkv</param>
+        /// <returns>Non-negative value on success, negative on failure</returns>
+        [DllImport("UnityAV.Native")]
+        private static extern int SaveClip(int id, double secondsBefore, double secondsAfter,
+            string path);
+
         /// <summary>
         /// Begins or resumes playback
         /// </summary>
@@ -227,22 +447,192 @@ namespace UnityAV
             }
         }
 
-        private void Start()
+        /// <summary>
+        /// Queues media to be played once the current media has finished, the queued
+        /// media is prepared in the background so the transition is seamless
+        /// </summary>
+        /// <param name="uri">The uri of the media to queue</param>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public void Enqueue(string uri)
         {
-            NativeInitializer.Initialize(this);
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
 
-            var uri = string.Copy(Uri);
+            var result = Enqueue(_id, ResolveUri(uri));
 
-            if (!Uri.Contains(RTSPPrefix))
+            if (result < 0)
             {
-                uri = Application.streamingAssetsPath + Path.DirectorySeparatorChar + Uri;
+                throw new Exception($"Failed to enqueue with error {result}");
+            }
+        }
 
-                // ensure the file exists before moving forward
-                if (!File.Exists(uri))
-                {
-                    throw new FileNotFoundException($"{uri} not found.");
-                }
+        /// <summary>
+        /// Evaluates the runtime statistics
+        /// </summary>
+        /// <returns>The runtime statistics</returns>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public PlayerStatistics Statistics()
+        {
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
+
+            PlayerStatistics statistics;
+            var result = GetStatistics(_id, out statistics);
+
+            if (result < 0)
+            {
+                throw new Exception($"Failed to get statistics with error {result}");
+            }
+
+            return statistics;
+        }
+
+        /// <summary>
+        /// Adds an alternative profile of the stream, such as a camera's low resolution 
+        /// sub-stream, the smallest profile covering the display size is streamed
+        /// </summary>
+        /// <param name="uri">The uri of the profile</param>
+        /// <param name="width">The width of the profile's video in pixels</param>
+        /// <param name="height">The height of the profile's video in pixels</param>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public void AddStreamProfile(string uri, int width, int height)
+        {
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
+
+            var result = AddStreamProfile(_id, uri, width, height);
+
+            if (result < 0)
+            {
+                throw new Exception($"Failed to add stream profile with error {result}");
+            }
+        }
+
+        /// <summary>
+        /// Sets the size the media is displayed at on screen, live streams switch 
+        /// between their profiles to match without a gap in playback
+        /// </summary>
+        /// <param name="width">The displayed width in pixels</param>
+        /// <param name="height">The displayed height in pixels</param>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public void SetDisplaySize(int width, int height)
+        {
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
+
+            SetDisplaySize(_id, width, height);
+        }
+
+        /// <summary>
+        /// Limits how many frames a second the media is decoded and shown at, frames over
+        /// the limit are skipped before they cost decoding or conversion where they can be
+        /// </summary>
+        /// <param name="framesPerSecond">The most frames a second, zero is unlimited</param>
+        /// <exception cref="ArgumentOutOfRangeException">Thrown if the frame rate is 
+        /// negative</exception>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public void SetMaxFrameRate(double framesPerSecond)
+        {
+            if (framesPerSecond < 0)
+            {
+                throw new ArgumentOutOfRangeException(nameof(framesPerSecond));
+            }
+
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
+
+            SetMaxFrameRate(_id, framesPerSecond);
+        }
+
+        /// <summary>
+        /// Starts recording the media to a file as it plays, the compressed streams are
+        /// remuxed without decoding, live streams are recorded once connected
+        /// </summary>
+        /// <param name="path">The path of the file to record to, .mp4 or .mkv</param>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public void StartRecording(string path)
+        {
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
+
+            var result = StartRecording(_id, path);
+
+            if (result < 0)
+            {
+                throw new Exception($"Failed to start recording with error {result}");
+            }
+        }
+
+        /// <summary>
+        /// Stops recording the media and finishes the file
+        /// </summary>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public void StopRecording()
+        {
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
+
+            StopRecording(_id);
+        }
+
+        /// <summary>
+        /// Saves a clip of the media around now, beginning from the packets kept for
+        /// <see cref="ClipBufferSeconds"/> and written as the rest arrives
+        /// </summary>
+        /// <param name="secondsBefore">The seconds before now the clip begins</param>
+        /// <param name="secondsAfter">The seconds after now the clip ends</param>
+        /// <param name="path">The path of the file to save to, .mp4 or .mkv</param>
+        /// <exception cref="InvalidOperationException">Thrown if MediaPlayer failed to 
+        /// obtain a native player</exception>
+        public void SaveClip(double secondsBefore, double secondsAfter, string path)
+        {
+            if (!ValidatePlayerId(_id))
+            {
+                throw new InvalidOperationException($"{nameof(MediaPlayer)} has no " +
+                    "underlying valid native player.");
+            }
+
+            var result = SaveClip(_id, secondsBefore, secondsAfter, path);
+
+            if (result < 0)
+            {
+                throw new Exception($"Failed to save clip with error {result}");
             }
+        }
+
+        private void Start()
+        {
+            NativeInitializer.Initialize(this);
+
+            var uri = ResolveUri(Uri);
 
             // create the texture to write to
             _targetTexture = new Texture2D(Width, Height, TextureFormat.ARGB32, false)
@@ -252,7 +642,32 @@ namespace UnityAV
             };
 
             // register the texture and get the id from the native plugin
-            _id = GetPlayer(uri, _targetTexture.GetNativeTexturePtr());
+            var options = new PlayerOptions
+            {
+                CacheInMemory = CacheInMemory,
+                CacheDecodedFrames = CacheDecodedFrames,
+                FrameCacheMegabytes = FrameCacheMegabytes,
+                ShareDecoding = ShareDecoding,
+                SharedTimeline = SharedTimeline,
+                LowLatency = LowLatency,
+                JitterBufferFactor = JitterBufferFactor,
+                Transport = Transport,
+                ReceiveBufferKilobytes = ReceiveBufferKilobytes,
+                RequestKeyframes = RequestKeyframes,
+                ReceiveAudio = ReceiveAudio,
+                ReceiveData = ReceiveData,
+                TimeShiftSeconds = TimeShiftSeconds,
+                TimeShiftMegabytes = TimeShiftMegabytes,
+                TimeShiftSpillMegabytes = TimeShiftSpillMegabytes,
+                CatchUpSpeed = CatchUpSpeed,
+                ClipBufferSeconds = ClipBufferSeconds,
+                ClipBufferMegabytes = ClipBufferMegabytes,
+                Backend = Backend,
+                IntraDecoders = IntraDecoders,
+                AdaptiveQuality = AdaptiveQuality
+            };
+
+            _id = GetPlayerWithOptions(uri, _targetTexture.GetNativeTexturePtr(), ref options);
 
             if (ValidatePlayerId(_id))
             {
@@ -299,6 +714,24 @@ namespace UnityAV
             }
         }
 
+        private static string ResolveUri(string uri)
+        {
+            var resolved = string.Copy(uri);
+
+            if (!uri.Contains(RTSPPrefix))
+            {
+                resolved = Application.streamingAssetsPath + Path.DirectorySeparatorChar + uri;
+
+                // ensure the file exists before moving forward
+                if (!File.Exists(resolved))
+                {
+                    throw new FileNotFoundException($"{resolved} not found.");
+                }
+            }
+
+            return resolved;
+        }
+
         private static bool ValidatePlayerId(int id)
         {
             return id >= 0;
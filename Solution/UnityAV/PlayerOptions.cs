@@ -0,0 +1,125 @@
+﻿using System.Runtime.InteropServices;
+
+namespace UnityAV
+{
+    /// <summary>
+    /// The options a native player is created with, mirrors the native PlayerOptions
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct PlayerOptions
+    {
+        /// <summary>
+        /// Should file media be loaded into memory once and shared between players?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool CacheInMemory;
+
+        /// <summary>
+        /// Should decoded frames of the first pass be kept to serve later loops?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool CacheDecodedFrames;
+
+        /// <summary>
+        /// The memory budget of the decoded frame cache in megabytes
+        /// </summary>
+        public int FrameCacheMegabytes;
+
+        /// <summary>
+        /// Should the source and decoding be shared with other players of the same uri?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool ShareDecoding;
+
+        /// <summary>
+        /// Should sharing players of a file also share play, stop and seek?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool SharedTimeline;
+
+        /// <summary>
+        /// Should live streams present the newest frame as soon as it is decoded?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool LowLatency;
+
+        /// <summary>
+        /// How many multiples of the measured network jitter live frames are held back by
+        /// </summary>
+        public float JitterBufferFactor;
+
+        /// <summary>
+        /// How rtp is carried for rtsp sessions
+        /// </summary>
+        public RTSPTransport Transport;
+
+        /// <summary>
+        /// The receive buffer size requested for udp rtp sockets in kilobytes
+        /// </summary>
+        public int ReceiveBufferKilobytes;
+
+        /// <summary>
+        /// Should live streams ask the server for a keyframe when joining or after loss?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool RequestKeyframes;
+
+        /// <summary>
+        /// Should the audio subsessions of rtsp sessions be received?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool ReceiveAudio;
+
+        /// <summary>
+        /// Should the metadata subsessions of rtsp sessions be received?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool ReceiveData;
+
+        /// <summary>
+        /// How many seconds of a live stream are kept so it can be paused and rewound
+        /// </summary>
+        public int TimeShiftSeconds;
+
+        /// <summary>
+        /// The memory budget of the time shift window in megabytes
+        /// </summary>
+        public int TimeShiftMegabytes;
+
+        /// <summary>
+        /// The megabytes of the time shift window which may spill into a temporary file
+        /// </summary>
+        public int TimeShiftSpillMegabytes;
+
+        /// <summary>
+        /// The speed time shifted playback runs at to catch up with the live stream
+        /// </summary>
+        public float CatchUpSpeed;
+
+        /// <summary>
+        /// How many seconds of packets are kept so saved clips can begin before the call
+        /// </summary>
+        public int ClipBufferSeconds;
+
+        /// <summary>
+        /// The memory budget of the packets kept for clips in megabytes
+        /// </summary>
+        public int ClipBufferMegabytes;
+
+        /// <summary>
+        /// Which implementation receives rtsp sessions
+        /// </summary>
+        public RTSPBackend Backend;
+
+        /// <summary>
+        /// How many codec contexts decode intra only streams in parallel, zero for automatic
+        /// </summary>
+        public int IntraDecoders;
+
+        /// <summary>
+        /// Should decoding trade quality for speed when playback falls behind?
+        /// </summary>
+        [MarshalAs(UnmanagedType.U1)]
+        public bool AdaptiveQuality;
+    }
+}
@@ -0,0 +1,87 @@
+﻿using System.Runtime.InteropServices;
+
+namespace UnityAV
+{
+    /// <summary>
+    /// The runtime statistics of a native player, mirrors the native PlayerStatistics
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct PlayerStatistics
+    {
+        /// <summary>
+        /// The number of frames served from the decoded frame cache
+        /// </summary>
+        public long CacheHits;
+
+        /// <summary>
+        /// The number of frames that had to be decoded while caching was enabled
+        /// </summary>
+        public long CacheMisses;
+
+        /// <summary>
+        /// The size of the decoded frame cache in bytes
+        /// </summary>
+        public long CachedBytes;
+
+        /// <summary>
+        /// The number of frames held in the decoded frame cache
+        /// </summary>
+        public int CachedFrames;
+
+        /// <summary>
+        /// The number of live frames waiting in the jitter buffer
+        /// </summary>
+        public int JitterBufferDepth;
+
+        /// <summary>
+        /// The number of live frames dropped for arriving too late to be shown
+        /// </summary>
+        public long LateFrames;
+
+        /// <summary>
+        /// The measured interarrival jitter of live frames in milliseconds
+        /// </summary>
+        public double JitterMilliseconds;
+
+        /// <summary>
+        /// The delay live frames are currently held back by in milliseconds
+        /// </summary>
+        public double JitterBufferDelayMilliseconds;
+
+        /// <summary>
+        /// The number of rtp packets received by live streams
+        /// </summary>
+        public long PacketsReceived;
+
+        /// <summary>
+        /// The number of rtp packets live streams expected but never received
+        /// </summary>
+        public long PacketsLost;
+
+        /// <summary>
+        /// The number of live frames dropped for not fitting the receive buffer
+        /// </summary>
+        public long TruncatedFrames;
+
+        /// <summary>
+        /// The number of live frames dropped while waiting for a keyframe after joining or
+        /// losing data
+        /// </summary>
+        public long FramesAwaitingKeyframe;
+
+        /// <summary>
+        /// The number of times live streams asked the server for a keyframe
+        /// </summary>
+        public long KeyframeRequests;
+
+        /// <summary>
+        /// The number of times decoding stepped its quality down or up
+        /// </summary>
+        public long QualityChanges;
+
+        /// <summary>
+        /// How far decoding has degraded to keep up, zero is full quality
+        /// </summary>
+        public int QualityLevel;
+    }
+}
@@ -0,0 +1,18 @@
+﻿namespace UnityAV
+{
+    /// <summary>
+    /// Which implementation receives rtsp sessions, mirrors the native RTSPBackend
+    /// </summary>
+    public enum RTSPBackend
+    {
+        /// <summary>
+        /// live555, supporting profiles, time shifting and keyframe requests
+        /// </summary>
+        Live555 = 0,
+
+        /// <summary>
+        /// libavformat's own rtsp demuxer, which some cameras work better with
+        /// </summary>
+        AVFormat
+    }
+}
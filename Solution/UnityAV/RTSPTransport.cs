@@ -0,0 +1,23 @@
+﻿namespace UnityAV
+{
+    /// <summary>
+    /// How rtp is carried for a rtsp session, mirrors the native RTSPTransport
+    /// </summary>
+    public enum RTSPTransport
+    {
+        /// <summary>
+        /// Unicast udp, the lowest latency but packets may be lost under load
+        /// </summary>
+        Udp = 0,
+
+        /// <summary>
+        /// Interleaved over the rtsp tcp connection, no packets are lost
+        /// </summary>
+        Tcp,
+
+        /// <summary>
+        /// Multicast udp where the server offers it
+        /// </summary>
+        Multicast
+    }
+}